@@ -4,38 +4,101 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../source/benchmark.c \
+../source/calibration.c \
+../source/console.c \
+../source/curve.c \
+../source/deferred.c \
+../source/delay.c \
+../source/fade.c \
+../source/hsv.c \
 ../source/i2c.c \
+../source/idle.c \
 ../source/led.c \
+../source/lptmr.c \
 ../source/main.c \
 ../source/mma8451q.c \
+../source/motion.c \
 ../source/mtb.c \
+../source/nvm.c \
+../source/orientation.c \
+../source/pipeline.c \
+../source/queue.c \
+../source/sampling.c \
+../source/scene.c \
+../source/scheduler.c \
 ../source/semihost_hardfault.c \
-../source/tpm.c 
+../source/timebase.c \
+../source/tpm.c \
+../source/watchdog.c \
+../source/ws2812.c 
 
 C_DEPS += \
+./source/benchmark.d \
+./source/calibration.d \
+./source/console.d \
+./source/curve.d \
+./source/deferred.d \
+./source/delay.d \
+./source/fade.d \
+./source/hsv.d \
 ./source/i2c.d \
+./source/idle.d \
 ./source/led.d \
+./source/lptmr.d \
 ./source/main.d \
 ./source/mma8451q.d \
+./source/motion.d \
 ./source/mtb.d \
+./source/nvm.d \
+./source/orientation.d \
+./source/pipeline.d \
+./source/queue.d \
+./source/sampling.d \
+./source/scene.d \
+./source/scheduler.d \
 ./source/semihost_hardfault.d \
-./source/tpm.d 
+./source/timebase.d \
+./source/tpm.d \
+./source/watchdog.d \
+./source/ws2812.d 
 
 OBJS += \
+./source/benchmark.o \
+./source/calibration.o \
+./source/console.o \
+./source/curve.o \
+./source/deferred.o \
+./source/delay.o \
+./source/fade.o \
+./source/hsv.o \
 ./source/i2c.o \
+./source/idle.o \
 ./source/led.o \
+./source/lptmr.o \
 ./source/main.o \
 ./source/mma8451q.o \
+./source/motion.o \
 ./source/mtb.o \
+./source/nvm.o \
+./source/orientation.o \
+./source/pipeline.o \
+./source/queue.o \
+./source/sampling.o \
+./source/scene.o \
+./source/scheduler.o \
 ./source/semihost_hardfault.o \
-./source/tpm.o 
+./source/timebase.o \
+./source/tpm.o \
+./source/watchdog.o \
+./source/ws2812.o 
 
 
 # Each subdirectory must supply rules for building sources it contributes
 source/%.o: ../source/%.c source/subdir.mk
 	@echo 'Building file: $<'
 	@echo 'Invoking: MCU C Compiler'
-	arm-none-eabi-gcc -D__REDLIB__ -DCPU_MKL25Z128VLK4 -DCPU_MKL25Z128VLK4_cm0plus -DFSL_RTOS_BM -DSDK_OS_BAREMETAL -DSDK_DEBUGCONSOLE=0 -DPRINTF_FLOAT_ENABLE=0 -DCR_INTEGER_PRINTF -DSDK_DEBUGCONSOLE_UART -D__MCUXPRESSO -D__USE_CMSIS -DDEBUG -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\board" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\source" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\drivers" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\CMSIS" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\utilities" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\startup" -O0 -fno-common -g3 -Wall -c -fmessage-length=0 -fno-builtin -ffunction-sections -fdata-sections -fmerge-constants -fmacro-prefix-map="$(<D)/"= -mcpu=cortex-m0plus -mthumb -D__REDLIB__ -fstack-usage -specs=redlib.specs -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.o)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	arm-none-eabi-gcc -D__REDLIB__ -DCPU_MKL25Z128VLK4 -DCPU_MKL25Z128VLK4_cm0plus -DFSL_RTOS_BM -DSDK_OS_BAREMETAL -DSDK_DEBUGCONSOLE=0 -DPRINTF_FLOAT_ENABLE=0 -DCR_INTEGER_PRINTF -DSDK_DEBUGCONSOLE_UART -D__MCUXPRESSO -D__USE_CMSIS -DDISABLE_WDOG=0 -DDEBUG -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\board" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\source" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\drivers" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\CMSIS" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\utilities" -I"C:\Users\dayton.flores\Documents\MCUXpressoIDE_11.6.0_8187\workspace\SpatialDimmer\startup" -O0 -fno-common -g3 -Wall -c -fmessage-length=0 -fno-builtin -ffunction-sections -fdata-sections -fmerge-constants -fmacro-prefix-map="$(<D)/"= -mcpu=cortex-m0plus -mthumb -D__REDLIB__ -fstack-usage -specs=redlib.specs -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.o)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
@@ -43,7 +106,7 @@ source/%.o: ../source/%.c source/subdir.mk
 clean: clean-source
 
 clean-source:
-	-$(RM) ./source/i2c.d ./source/i2c.o ./source/led.d ./source/led.o ./source/main.d ./source/main.o ./source/mma8451q.d ./source/mma8451q.o ./source/mtb.d ./source/mtb.o ./source/semihost_hardfault.d ./source/semihost_hardfault.o ./source/tpm.d ./source/tpm.o
+	-$(RM) ./source/benchmark.d ./source/benchmark.o ./source/calibration.d ./source/calibration.o ./source/console.d ./source/console.o ./source/curve.d ./source/curve.o ./source/deferred.d ./source/deferred.o ./source/delay.d ./source/delay.o ./source/fade.d ./source/fade.o ./source/hsv.d ./source/hsv.o ./source/i2c.d ./source/i2c.o ./source/idle.d ./source/idle.o ./source/led.d ./source/led.o ./source/lptmr.d ./source/lptmr.o ./source/main.d ./source/main.o ./source/mma8451q.d ./source/mma8451q.o ./source/motion.d ./source/motion.o ./source/mtb.d ./source/mtb.o ./source/nvm.d ./source/nvm.o ./source/orientation.d ./source/orientation.o ./source/pipeline.d ./source/pipeline.o ./source/queue.d ./source/queue.o ./source/sampling.d ./source/sampling.o ./source/scene.d ./source/scene.o ./source/scheduler.d ./source/scheduler.o ./source/semihost_hardfault.d ./source/semihost_hardfault.o ./source/timebase.d ./source/timebase.o ./source/tpm.d ./source/tpm.o ./source/watchdog.d ./source/watchdog.o ./source/ws2812.d ./source/ws2812.o
 
 .PHONY: clean-source
 
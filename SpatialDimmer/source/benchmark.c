@@ -0,0 +1,297 @@
+/**
+ * @file	benchmark.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for on-target cycle benchmarks
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdio.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "benchmark.h"
+#include "led.h"		// Keep led.h included before mma8451q.h for led_color_t typedef
+#include "pipeline.h"	// Keep pipeline.h included before mma8451q.h for sample_block_t typedef
+#include "mma8451q.h"
+#include "hsv.h"
+#include "scene.h"
+#include "timebase.h"
+#include "tpm.h"
+#include "ws2812.h"
+
+
+
+/**
+ * @brief	Cycles the Cortex-M0+ spends entering and returning from an
+ * 			interrupt, which the dither interrupt pays on top of its body
+ */
+#define BENCHMARK_ISR_ENTRY_EXIT_CYCLES\
+	(32)
+
+
+
+/**
+ * @brief	The PWM frequencies the dither interrupt load is reported for:
+ * 			the default and camera-safe lighting
+ */
+#define BENCHMARK_DITHER_LOW_HZ\
+	(500)
+#define BENCHMARK_DITHER_HIGH_HZ\
+	(20000)
+
+
+
+/**
+ * @brief	The amount of WS2812 frames encoded when timing a fill. Kept low
+ * 			since each frame is thousands of bytes
+ */
+#define BENCHMARK_WS2812_FRAMES\
+	(10)
+
+
+
+/**
+ * @brief	The strip lengths the WS2812 refresh rate is reported for
+ */
+static const uint16_t benchmark_ws2812_pixels[] = {
+	30, 60, 144, 300, 600
+};
+
+
+
+/**
+ * @brief	Where timebase reads are stored while benchmarking, so they are not
+ * 			optimized away
+ */
+static volatile uint64_t benchmark_timestamp;
+
+
+
+/**
+ * @brief	Cycles spent by benchmark_start()/benchmark_stop() themselves,
+ * 			measured once and subtracted from every result
+ */
+static uint32_t benchmark_overhead = 0;
+
+
+
+/**
+ * @brief	Division-based XYZ to RGB mapping as it was before the mapping was
+ * 			resolved at build time. Kept only as a baseline to compare against
+ */
+static volatile int benchmark_rgb_levels = RGB_LEVELS;
+static volatile int benchmark_xyz_levels = XYZ_LEVELS;
+
+static void calculate_rgb_from_xyz_divide(accelerometer_axis_t accelerometer_axis, led_color_t led_color){
+
+	int32_t xyz = 0;
+	int32_t rgb = 0;
+
+	switch(accelerometer_axis){
+	case x:
+		xyz = current_x + XYZ_OFFSET;
+		break;
+	case y:
+		xyz = current_y + XYZ_OFFSET;
+		break;
+	case z:
+		xyz = current_z + XYZ_OFFSET;
+		break;
+	default:
+		break;
+	}
+
+	if(benchmark_rgb_levels < benchmark_xyz_levels){
+		rgb = xyz / (benchmark_xyz_levels / benchmark_rgb_levels);
+	}
+
+	switch(led_color){
+	case red:
+		current_red_level = rgb;
+		break;
+	case green:
+		current_green_level = rgb;
+		break;
+	case blue:
+		current_blue_level = rgb;
+		break;
+	default:
+		break;
+	}
+}
+
+
+
+uint32_t benchmark_start(void){
+
+	/**
+	 * Start SysTick free-running from its largest reload value if it is
+	 * not already in use
+	 */
+	if((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0){
+		SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+		SysTick->VAL = 0;
+		SysTick->CTRL =
+			SysTick_CTRL_CLKSOURCE_Msk |
+			SysTick_CTRL_ENABLE_Msk;
+	}
+
+	return (SysTick->VAL);
+}
+
+
+
+uint32_t benchmark_stop(uint32_t start){
+
+	/**
+	 * Used to hold the SysTick value at the end of the measurement
+	 */
+	uint32_t end = SysTick->VAL;
+	uint32_t reload = (SysTick->LOAD + 1);
+
+
+
+	/**
+	 * SysTick counts down, so elapsed cycles are start - end modulo reload
+	 */
+	return ((start >= end) ? (start - end) : (start + reload - end));
+}
+
+
+
+void run_benchmarks(void){
+
+	/**
+	 * Used to hold the measurement start value, elapsed cycles and WS2812
+	 * refresh rate
+	 */
+	uint32_t start;
+	uint32_t cycles;
+	uint32_t refresh;
+
+
+
+	/**
+	 * Measure the cost of the measurement itself
+	 */
+	start = benchmark_start();
+	benchmark_overhead = benchmark_stop(start);
+
+
+
+	/**
+	 * Use a sample that exercises the whole mapping
+	 */
+	current_x = XYZ_MAX;
+	current_y = 0;
+	current_z = XYZ_MIN;
+
+
+
+	/**
+	 * XYZ to RGB: division baseline vs mapping resolved at build time
+	 */
+	start = benchmark_start();
+	for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+		calculate_rgb_from_xyz_divide(x, red);
+		calculate_rgb_from_xyz_divide(y, green);
+		calculate_rgb_from_xyz_divide(z, blue);
+	}
+	cycles = benchmark_stop(start) - benchmark_overhead;
+	printf("BENCH xyz->rgb divide: %lu cycles/sample\r\n", (unsigned long)(cycles / BENCHMARK_ITERATIONS));
+
+	start = benchmark_start();
+	for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+		calculate_rgb_from_xyz(x, red);
+		calculate_rgb_from_xyz(y, green);
+		calculate_rgb_from_xyz(z, blue);
+	}
+	cycles = benchmark_stop(start) - benchmark_overhead;
+	printf("BENCH xyz->rgb mapped: %lu cycles/sample\r\n", (unsigned long)(cycles / BENCHMARK_ITERATIONS));
+
+	start = benchmark_start();
+	for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+		calculate_rgb_from_hsv();
+	}
+	cycles = benchmark_stop(start) - benchmark_overhead;
+	printf("BENCH xyz->rgb hsv: %lu cycles/sample\r\n", (unsigned long)(cycles / BENCHMARK_ITERATIONS));
+
+
+
+	/**
+	 * Timebase: cost of reading the 64-bit clock and its lower half
+	 */
+	start = benchmark_start();
+	for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+		benchmark_timestamp = get_timebase_us();
+	}
+	cycles = benchmark_stop(start) - benchmark_overhead;
+	printf("BENCH timebase us64: %lu cycles/read\r\n", (unsigned long)(cycles / BENCHMARK_ITERATIONS));
+
+	start = benchmark_start();
+	for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+		benchmark_timestamp = get_timebase_us32();
+	}
+	cycles = benchmark_stop(start) - benchmark_overhead;
+	printf("BENCH timebase us32: %lu cycles/read\r\n", (unsigned long)(cycles / BENCHMARK_ITERATIONS));
+
+
+
+	/**
+	 * Dither interrupt: cycles per PWM period, and the share of the CPU it
+	 * takes in hundredths of a percent at each PWM frequency
+	 */
+	start = benchmark_start();
+	for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+		tpm_period_update();
+	}
+	cycles = ((benchmark_stop(start) - benchmark_overhead) / BENCHMARK_ITERATIONS) + BENCHMARK_ISR_ENTRY_EXIT_CYCLES;
+	printf("BENCH dither isr: %lu cycles/period\r\n", (unsigned long)cycles);
+	printf("BENCH dither isr @ %u Hz: %lu/10000 CPU\r\n", BENCHMARK_DITHER_LOW_HZ,
+		(unsigned long)((cycles * BENCHMARK_DITHER_LOW_HZ) / (SystemCoreClock / 10000)));
+	printf("BENCH dither isr @ %u Hz: %lu/10000 CPU\r\n", BENCHMARK_DITHER_HIGH_HZ,
+		(unsigned long)((cycles * BENCHMARK_DITHER_HIGH_HZ) / (SystemCoreClock / 10000)));
+
+
+
+	/**
+	 * Dither interrupt with a scene playing and blending, which every few
+	 * periods defers an interpolation and publish. From thread mode PendSV
+	 * runs as soon as it is pended, so its share is included
+	 */
+	start_scene(&scene_color_cycle, scene_blend_mix, 128);
+	start = benchmark_start();
+	for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+		tpm_period_update();
+	}
+	cycles = ((benchmark_stop(start) - benchmark_overhead) / BENCHMARK_ITERATIONS) + BENCHMARK_ISR_ENTRY_EXIT_CYCLES;
+	stop_scene();
+	printf("BENCH scene isr + pendsv: %lu cycles/period\r\n", (unsigned long)cycles);
+
+
+
+	/**
+	 * WS2812: cost of encoding a whole frame, and the refresh rate reachable
+	 * for a range of strip lengths
+	 */
+	start = benchmark_start();
+	for(int i = 0; i < BENCHMARK_WS2812_FRAMES; i++){
+		fill_ws2812_pixels(RGB_MAX, RGB_MIN, RGB_MAX);
+	}
+	cycles = benchmark_stop(start) - benchmark_overhead;
+	printf("BENCH ws2812 fill %u pixels: %lu cycles/frame\r\n", WS2812_PIXELS, (unsigned long)(cycles / BENCHMARK_WS2812_FRAMES));
+	for(uint32_t i = 0; i < (sizeof(benchmark_ws2812_pixels) / sizeof(benchmark_ws2812_pixels[0])); i++){
+		refresh = get_ws2812_refresh_centihz(benchmark_ws2812_pixels[i]);
+		printf("BENCH ws2812 %u pixels: %lu.%02lu Hz\r\n", benchmark_ws2812_pixels[i],
+			(unsigned long)(refresh / 100), (unsigned long)(refresh % 100));
+	}
+}
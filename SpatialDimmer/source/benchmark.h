@@ -0,0 +1,56 @@
+/**
+ * @file	benchmark.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros and function headers for on-target cycle benchmarks
+ */
+
+
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+
+
+/**
+ * @brief	The amount of times each benchmarked operation is repeated. The
+ * 			reported value is the average cycles per iteration
+ */
+#define BENCHMARK_ITERATIONS\
+	(1000)
+
+
+
+/**
+ * @brief	Start counting core clock cycles with SysTick
+ * @return	The SysTick value at the start of the measurement
+ * @detail
+ * 		SysTick is a 24-bit down counter clocked by the core clock. If SysTick
+ * 		is already running (e.g. as a periodic tick) it is left untouched and
+ * 		the measurement wraps modulo its reload value instead
+ */
+uint32_t benchmark_start(void);
+
+
+
+/**
+ * @brief	Stop counting core clock cycles
+ * @param	start - The value returned by benchmark_start()
+ * @return	The amount of core clock cycles elapsed since benchmark_start()
+ */
+uint32_t benchmark_stop(uint32_t start);
+
+
+
+/**
+ * @brief	Run all benchmarks and print average cycles per iteration over
+ * 			the debug console
+ * @detail
+ * 		Only called from main() when built with BENCHMARK defined, since it
+ * 		overwrites current_x/current_y/current_z and the current RGB levels
+ */
+void run_benchmarks(void);
+
+
+
+#endif /* BENCHMARK_H_ */
@@ -0,0 +1,259 @@
+/**
+ * @file	calibration.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for per-board LED color calibration
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "calibration.h"
+#include "console.h"
+#include "led.h"
+#include "nvm.h"
+#include "tpm.h"
+
+
+
+/**
+ * @brief	The identity calibration, used until a calibration is saved
+ */
+static const calibration_t calibration_identity = {
+	.matrix = {
+		{CALIBRATION_ONE_Q12, 0, 0},
+		{0, CALIBRATION_ONE_Q12, 0},
+		{0, 0, CALIBRATION_ONE_Q12}
+	},
+	.max_level = {RGB_MAX, RGB_MAX, RGB_MAX}
+};
+
+
+
+/**
+ * @brief	The calibration currently applied to every RGB update
+ */
+static calibration_t calibration;
+
+
+
+/**
+ * @brief	Fast paths: whether the matrix is identity and whether the whole
+ * 			calibration is
+ */
+static bool calibration_matrix_is_identity;
+static bool calibration_is_identity;
+
+
+
+/**
+ * @brief	Clamp a corrected level to between RGB_MIN and a max level
+ */
+static inline int16_t calibration_clamp(int32_t level, int16_t max_level){
+
+	if(level < RGB_MIN){
+		return RGB_MIN;
+	}
+	if(level > max_level){
+		return max_level;
+	}
+
+	return ((int16_t)level);
+}
+
+
+
+void init_calibration(void){
+
+	/**
+	 * Used to hold the calibration read from flash
+	 */
+	calibration_t saved;
+
+
+
+	/**
+	 * Use the saved calibration if it is valid, otherwise identity
+	 */
+	if((nvm_read_record(NVM_CALIBRATION_SECTOR, CALIBRATION_NVM_MAGIC, &saved, sizeof(saved)) != EXIT_SUCCESS) ||
+		(set_calibration(&saved) != EXIT_SUCCESS)){
+		set_calibration(&calibration_identity);
+	}
+}
+
+
+
+int set_calibration(const calibration_t *new_calibration){
+
+	/**
+	 * Used to work out the fast paths of the new calibration
+	 */
+	bool matrix_is_identity = true;
+	bool limits_are_max = true;
+
+
+
+	/**
+	 * Validate every entry
+	 */
+	for(int r = 0; r < 3; r++){
+		for(int c = 0; c < 3; c++){
+			int16_t entry = new_calibration->matrix[r][c];
+			if((entry > CALIBRATION_MAX_Q12) || (entry < -CALIBRATION_MAX_Q12)){
+				return EXIT_FAILURE;
+			}
+			if(entry != calibration_identity.matrix[r][c]){
+				matrix_is_identity = false;
+			}
+		}
+		if((new_calibration->max_level[r] < RGB_MIN) || (new_calibration->max_level[r] > RGB_MAX)){
+			return EXIT_FAILURE;
+		}
+		if(new_calibration->max_level[r] != RGB_MAX){
+			limits_are_max = false;
+		}
+	}
+
+
+
+	/**
+	 * Switch to the new calibration
+	 */
+	calibration = *new_calibration;
+	calibration_matrix_is_identity = matrix_is_identity;
+	calibration_is_identity = (matrix_is_identity && limits_are_max);
+
+	return EXIT_SUCCESS;
+}
+
+
+
+int save_calibration(void){
+
+	return (nvm_write_record(NVM_CALIBRATION_SECTOR, CALIBRATION_NVM_MAGIC, &calibration, sizeof(calibration)));
+}
+
+
+
+void calibrate_rgb_levels(int16_t *red_level, int16_t *green_level, int16_t *blue_level){
+
+	/**
+	 * Used to hold the requested levels before they are overwritten
+	 */
+	int32_t requested[3];
+
+
+
+	/**
+	 * Nothing to do for an uncalibrated board
+	 */
+	if(calibration_is_identity){
+		return;
+	}
+
+
+
+	/**
+	 * Mix through the matrix with rounding unless it is identity, then
+	 * limit each channel
+	 */
+	if(!calibration_matrix_is_identity){
+		requested[0] = *red_level;
+		requested[1] = *green_level;
+		requested[2] = *blue_level;
+		*red_level = calibration_clamp((
+			(calibration.matrix[0][0] * requested[0]) +
+			(calibration.matrix[0][1] * requested[1]) +
+			(calibration.matrix[0][2] * requested[2]) +
+			(CALIBRATION_ONE_Q12 / 2)) >> 12, calibration.max_level[0]);
+		*green_level = calibration_clamp((
+			(calibration.matrix[1][0] * requested[0]) +
+			(calibration.matrix[1][1] * requested[1]) +
+			(calibration.matrix[1][2] * requested[2]) +
+			(CALIBRATION_ONE_Q12 / 2)) >> 12, calibration.max_level[1]);
+		*blue_level = calibration_clamp((
+			(calibration.matrix[2][0] * requested[0]) +
+			(calibration.matrix[2][1] * requested[1]) +
+			(calibration.matrix[2][2] * requested[2]) +
+			(CALIBRATION_ONE_Q12 / 2)) >> 12, calibration.max_level[2]);
+	}
+	else{
+		*red_level = calibration_clamp(*red_level, calibration.max_level[0]);
+		*green_level = calibration_clamp(*green_level, calibration.max_level[1]);
+		*blue_level = calibration_clamp(*blue_level, calibration.max_level[2]);
+	}
+}
+
+
+
+void handle_calibration_command(char *arguments){
+
+	/**
+	 * Used to hold the calibration being edited and parse position
+	 */
+	calibration_t edited = calibration;
+	char *next = arguments;
+	long row;
+	long value;
+
+
+
+	/**
+	 * Handle the command
+	 */
+	if(*arguments == '\0'){
+		for(int r = 0; r < 3; r++){
+			printf("CAL row %d = (%d, %d, %d) max %d\r\n", r,
+				calibration.matrix[r][0], calibration.matrix[r][1], calibration.matrix[r][2],
+				calibration.max_level[r]);
+		}
+		return;
+	}
+	else if(match_console_word(&next, "row")){
+		if(parse_console_number(&next, 0, 2, &row) != EXIT_SUCCESS){
+			printf("CAL error: row must be 0, 1 or 2\r\n");
+			return;
+		}
+		for(int c = 0; c < 3; c++){
+			if(parse_console_number(&next, -CALIBRATION_MAX_Q12, CALIBRATION_MAX_Q12, &value) != EXIT_SUCCESS){
+				printf("CAL error: value out of range\r\n");
+				return;
+			}
+			edited.matrix[row][c] = (int16_t)value;
+		}
+	}
+	else if(match_console_word(&next, "max")){
+		for(int r = 0; r < 3; r++){
+			if(parse_console_number(&next, RGB_MIN, RGB_MAX, &value) != EXIT_SUCCESS){
+				printf("CAL error: value out of range\r\n");
+				return;
+			}
+			edited.max_level[r] = (int16_t)value;
+		}
+	}
+	else if(match_console_word(&next, "identity")){
+		edited = calibration_identity;
+	}
+	else if(match_console_word(&next, "save")){
+		printf("CAL save %s\r\n", (save_calibration() == EXIT_SUCCESS) ? "ok" : "failed");
+		return;
+	}
+	else{
+		printf("CAL error: unknown command\r\n");
+		return;
+	}
+
+	printf("CAL %s\r\n", (set_calibration(&edited) == EXIT_SUCCESS) ? "ok" : "error: value out of range");
+}
@@ -0,0 +1,115 @@
+/**
+ * @file	calibration.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros, types and function headers for per-board LED color
+ * 			calibration
+ */
+
+
+
+#ifndef CALIBRATION_H_
+#define CALIBRATION_H_
+
+
+
+/**
+ * @brief	1.0 in the Q12 fixed-point format of the color correction matrix
+ */
+#define CALIBRATION_ONE_Q12\
+	(4096)
+
+
+
+/**
+ * @brief	The largest magnitude of a matrix entry (2.0), which keeps the
+ * 			multiply-accumulate within 32 bits
+ */
+#define CALIBRATION_MAX_Q12\
+	(2 * CALIBRATION_ONE_Q12)
+
+
+
+/**
+ * @brief	Identifies a calibration record in flash ("CALB")
+ */
+#define CALIBRATION_NVM_MAGIC\
+	(0x43414C42)
+
+
+
+/**
+ * @brief	A per-board LED color calibration
+ * @detail
+ * 		matrix:		Row r gives how much of each requested level (red, green,
+ * 					blue) goes into output channel r, in Q12
+ * 		max_level:	The highest level each output channel (red, green, blue)
+ * 					is ever driven to, between RGB_MIN and RGB_MAX
+ */
+typedef struct calibration_s{
+	int16_t matrix[3][3];
+	int16_t max_level[3];
+} calibration_t;
+
+
+
+/**
+ * @brief	Load the calibration saved in flash, or the identity calibration
+ * 			if none has been saved
+ */
+void init_calibration(void);
+
+
+
+/**
+ * @brief	Switch to a new calibration
+ * @param	new_calibration - The calibration to use
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if a matrix entry is beyond
+ * 			CALIBRATION_MAX_Q12 or a max level is outside of the RGB range
+ */
+int set_calibration(const calibration_t *new_calibration);
+
+
+
+/**
+ * @brief	Save the current calibration to flash
+ * @return	EXIT_SUCCESS or EXIT_FAILURE
+ */
+int save_calibration(void);
+
+
+
+/**
+ * @brief	Correct RGB levels for this board's LEDs
+ * @param	red_level - The red level, corrected in place
+ * @param	green_level - The green level, corrected in place
+ * @param	blue_level - The blue level, corrected in place
+ * @detail
+ * 		Called by the render stage just before the levels become duties.
+ * 		The matrix multiply is skipped when the matrix is identity, and the
+ * 		whole correction when the max levels are also RGB_MAX
+ */
+void calibrate_rgb_levels(int16_t *red_level, int16_t *green_level, int16_t *blue_level);
+
+
+
+/**
+ * @brief	Handle a "cal" console command (see console.h)
+ * @param	arguments - The rest of the command line after "cal", without
+ * 			its leading spaces
+ * @detail
+ * 		cal						Print the current calibration
+ * 		cal row <r> <a> <b> <c>	Set row r (0 red, 1 green, 2 blue) of the
+ * 								matrix to a, b and c in Q12
+ * 		cal max <r> <g> <b>		Set the max level of each channel
+ * 		cal identity			Reset to the identity calibration
+ * 		cal save				Save the current calibration to flash
+ *
+ * 		Changes take effect on the next RGB update, so a color can be trimmed
+ * 		by eye before it is saved
+ */
+void handle_calibration_command(char *arguments);
+
+
+
+#endif /* CALIBRATION_H_ */
@@ -0,0 +1,648 @@
+/**
+ * @file	console.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for the debug UART console
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "calibration.h"
+#include "console.h"
+#include "led.h"		// Keep led.h included before mma8451q.h for led_color_t typedef
+#include "pipeline.h"	// Keep pipeline.h included before mma8451q.h for sample_block_t typedef
+#include "mma8451q.h"
+#include "curve.h"
+#include "fade.h"
+#include "orientation.h"
+#include "sampling.h"
+#include "scene.h"
+#include "scheduler.h"
+#include "tpm.h"
+
+
+
+/**
+ * @brief	The longest command line accepted over the debug UART
+ */
+#define CONSOLE_LINE_SIZE\
+	(48)
+
+
+
+/**
+ * @brief	A console command and the function handling the rest of its line
+ */
+typedef struct console_command_s{
+	const char *name;
+	void (*handle)(char *arguments);
+} console_command_t;
+
+
+
+/**
+ * @brief	A curve type by the name used on the console
+ */
+typedef struct console_curve_s{
+	const char *name;
+	curve_type_t type;
+} console_curve_t;
+
+
+
+/**
+ * @brief	A scene by the name used on the console
+ */
+typedef struct console_scene_s{
+	const char *name;
+	const scene_t *scene;
+} console_scene_t;
+
+
+
+/**
+ * @brief	The curve types the curve command takes
+ */
+static const console_curve_t console_curves[] = {
+	{.name = "linear", .type = curve_linear},
+	{.name = "gamma", .type = curve_gamma},
+	{.name = "scurve", .type = curve_s_curve},
+	{.name = "deadzone", .type = curve_dead_zone},
+	{.name = "piecewise", .type = curve_piecewise}
+};
+
+
+
+/**
+ * @brief	The fade curves by the name used on the console, in fade_curve_t
+ * 			order
+ */
+static const char *const console_fades[] = {
+	"linear", "in", "out", "inout"
+};
+
+
+
+/**
+ * @brief	The scenes the scene command can play
+ */
+static const console_scene_t console_scenes[] = {
+	{.name = "breathing", .scene = &scene_breathing},
+	{.name = "cycle", .scene = &scene_color_cycle},
+	{.name = "alert", .scene = &scene_alert}
+};
+
+
+
+/**
+ * @brief	The scene blend modes by the name used on the console, in
+ * 			scene_blend_t order
+ */
+static const char *const console_blends[] = {
+	"none", "mix", "multiply"
+};
+
+
+
+/**
+ * @brief	The mapping modes by the name used on the console, in
+ * 			mapping_mode_t order
+ */
+static const char *const console_mappings[] = {
+	"axis", "motion", "curve", "hsv"
+};
+
+
+
+/**
+ * @brief	The command line being received over the debug UART
+ */
+static char console_line[CONSOLE_LINE_SIZE];
+static uint8_t console_line_length = 0;
+
+
+
+int parse_console_number(char **next, long min, long max, long *value){
+
+	/**
+	 * Used to tell whether any digits were parsed
+	 */
+	char *start = *next;
+
+	*value = strtol(start, next, 10);
+	if((*next == start) || (*value < min) || (*value > max)){
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+
+bool match_console_word(char **next, const char *word){
+
+	/**
+	 * Used to hold the start of the next word and the length to match
+	 */
+	char *start = *next;
+	size_t length = strlen(word);
+
+
+
+	/**
+	 * Skip leading spaces, and only match whole words
+	 */
+	while(*start == ' '){
+		start++;
+	}
+	if((strncmp(start, word, length) != 0) || ((start[length] != ' ') && (start[length] != '\0'))){
+		return false;
+	}
+	*next = start + length;
+
+	return true;
+}
+
+
+
+/**
+ * @brief	Parse the next word of a command line as LED colors
+ * @param	next - The parse position, moved past the word
+ * @param	colors - Where to store the colors
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if the word is not made of r, g
+ * 			and b
+ * @detail
+ * 		Any of r, g and b combine, so "rb" is magenta and "rgb" is white
+ */
+static int console_parse_colors(char **next, led_color_t *colors){
+
+	/**
+	 * Used to hold the colors seen so far
+	 */
+	uint8_t combined = 0;
+
+
+
+	/**
+	 * Skip leading spaces, then take letters up to the end of the word
+	 */
+	while(**next == ' '){
+		(*next)++;
+	}
+	while((**next == 'r') || (**next == 'g') || (**next == 'b')){
+		combined |= (**next == 'r') ? red : ((**next == 'g') ? green : blue);
+		(*next)++;
+	}
+	if((combined == 0) || ((**next != ' ') && (**next != '\0'))){
+		return EXIT_FAILURE;
+	}
+	*colors = (led_color_t)combined;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+/**
+ * @brief	Handle an orientation command
+ * @param	arguments - The rest of the command line after "orient"
+ */
+static void console_orient_command(char *arguments){
+
+	/**
+	 * Used to hold the orientation being edited and parse position
+	 */
+	orientation_matrix_t edited;
+	char *next = arguments;
+	long row;
+	long value;
+
+
+
+	/**
+	 * Handle the command
+	 */
+	get_orientation(&edited);
+	if(*arguments == '\0'){
+		for(int r = 0; r < 3; r++){
+			printf("ORIENT row %d = (%d, %d, %d)\r\n", r, edited.m[r][0], edited.m[r][1], edited.m[r][2]);
+		}
+		return;
+	}
+	else if(match_console_word(&next, "row")){
+		if(parse_console_number(&next, 0, 2, &row) != EXIT_SUCCESS){
+			printf("ORIENT error: row must be 0, 1 or 2\r\n");
+			return;
+		}
+		for(int c = 0; c < 3; c++){
+			if(parse_console_number(&next, -ORIENTATION_ONE_Q14, ORIENTATION_ONE_Q14, &value) != EXIT_SUCCESS){
+				printf("ORIENT error: value out of range\r\n");
+				return;
+			}
+			edited.m[row][c] = (int16_t)value;
+		}
+	}
+	else if(match_console_word(&next, "identity")){
+		for(int r = 0; r < 3; r++){
+			for(int c = 0; c < 3; c++){
+				edited.m[r][c] = (r == c) ? ORIENTATION_ONE_Q14 : 0;
+			}
+		}
+	}
+	else if(match_console_word(&next, "save")){
+		printf("ORIENT save %s\r\n", (save_orientation() == EXIT_SUCCESS) ? "ok" : "failed");
+		return;
+	}
+	else{
+		printf("ORIENT error: unknown command\r\n");
+		return;
+	}
+
+	printf("ORIENT %s\r\n", (set_orientation(&edited) == EXIT_SUCCESS) ? "ok" : "error: value out of range");
+}
+
+
+
+/**
+ * @brief	Handle a response curve command
+ * @param	arguments - The rest of the command line after "curve"
+ */
+static void console_curve_command(char *arguments){
+
+	/**
+	 * Used to hold the curve being built, the colors it is for and parse
+	 * position
+	 */
+	curve_config_t config = {.type = curve_linear};
+	led_color_t colors;
+	char *next = arguments;
+	long value;
+	uint32_t i;
+
+
+
+	/**
+	 * Which colors
+	 */
+	if(console_parse_colors(&next, &colors) != EXIT_SUCCESS){
+		printf("CURVE error: colors must be any of r, g and b\r\n");
+		return;
+	}
+
+
+
+	/**
+	 * The curve type
+	 */
+	for(i = 0; i < (sizeof(console_curves) / sizeof(console_curves[0])); i++){
+		if(match_console_word(&next, console_curves[i].name)){
+			break;
+		}
+	}
+	if(i == (sizeof(console_curves) / sizeof(console_curves[0]))){
+		printf("CURVE error: unknown curve\r\n");
+		return;
+	}
+	config.type = console_curves[i].type;
+
+
+
+	/**
+	 * The knots of a piecewise curve as input output pairs, or the parameter
+	 * of the other curves that take one
+	 */
+	if(config.type == curve_piecewise){
+		while(*next == ' '){
+			next++;
+		}
+		while(*next != '\0'){
+			if(config.knot_count == CURVE_MAX_KNOTS){
+				printf("CURVE error: at most %d knots\r\n", CURVE_MAX_KNOTS);
+				return;
+			}
+			if(parse_console_number(&next, 0, UINT8_MAX, &value) != EXIT_SUCCESS){
+				printf("CURVE error: value out of range\r\n");
+				return;
+			}
+			config.knots[config.knot_count].input = (uint8_t)value;
+			if(parse_console_number(&next, 0, UINT8_MAX, &value) != EXIT_SUCCESS){
+				printf("CURVE error: value out of range\r\n");
+				return;
+			}
+			config.knots[config.knot_count++].output = (uint8_t)value;
+			while(*next == ' '){
+				next++;
+			}
+		}
+	}
+	else if(config.type != curve_linear){
+		if(parse_console_number(&next, 0, UINT16_MAX, &value) != EXIT_SUCCESS){
+			printf("CURVE error: value out of range\r\n");
+			return;
+		}
+		config.parameter = (uint16_t)value;
+	}
+
+
+
+	/**
+	 * Build the curve for each color. They are all validated alike, so
+	 * either every color switches or none does
+	 */
+	for(led_color_t color = red; color <= blue; color <<= 1){
+		if((colors & color) && (set_curve(color, &config) != EXIT_SUCCESS)){
+			printf("CURVE error: invalid curve\r\n");
+			return;
+		}
+	}
+	printf("CURVE ok\r\n");
+}
+
+
+
+/**
+ * @brief	Handle a mapping mode command
+ * @param	arguments - The rest of the command line after "map"
+ */
+static void console_map_command(char *arguments){
+
+	/**
+	 * Print the current mode, otherwise switch to the one named
+	 */
+	if(*arguments == '\0'){
+		printf("MAP %s\r\n", console_mappings[mapping_mode]);
+		return;
+	}
+	for(uint32_t i = 0; i < (sizeof(console_mappings) / sizeof(console_mappings[0])); i++){
+		if(match_console_word(&arguments, console_mappings[i])){
+			mapping_mode = (mapping_mode_t)i;
+			printf("MAP ok\r\n");
+			return;
+		}
+	}
+	printf("MAP error: unknown mapping\r\n");
+}
+
+
+
+/**
+ * @brief	Handle a fade command
+ * @param	arguments - The rest of the command line after "fade"
+ */
+static void console_fade_command(char *arguments){
+
+	/**
+	 * Used to hold the fade and parse position
+	 */
+	led_color_t colors;
+	long start_level;
+	long end_level;
+	long duration_ms;
+	fade_curve_t fade_curve = fade_linear;
+	char *next = arguments;
+
+
+
+	/**
+	 * Which colors, the levels, how long and optionally the fade curve
+	 */
+	if((console_parse_colors(&next, &colors) != EXIT_SUCCESS) ||
+		(parse_console_number(&next, RGB_MIN, RGB_MAX, &start_level) != EXIT_SUCCESS) ||
+		(parse_console_number(&next, RGB_MIN, RGB_MAX, &end_level) != EXIT_SUCCESS) ||
+		(parse_console_number(&next, 1, FADE_MAX_DURATION_MS, &duration_ms) != EXIT_SUCCESS)){
+		printf("FADE error: expected <colors> <start> <end> <ms>\r\n");
+		return;
+	}
+	while(*next == ' '){
+		next++;
+	}
+	if(*next != '\0'){
+		for(fade_curve = fade_linear; fade_curve <= fade_ease_in_out; fade_curve++){
+			if(match_console_word(&next, console_fades[fade_curve])){
+				break;
+			}
+		}
+		if(fade_curve > fade_ease_in_out){
+			printf("FADE error: unknown fade curve\r\n");
+			return;
+		}
+	}
+	if(start_fade(colors, (int16_t)start_level, (int16_t)end_level, (uint32_t)duration_ms, fade_curve) == EXIT_SUCCESS){
+		printf("FADE ok\r\n");
+	}
+	else{
+		printf("FADE error: %s\r\n", scene_active ? "a scene is running" : "cannot time the fade");
+	}
+}
+
+
+
+/**
+ * @brief	Handle a scene command
+ * @param	arguments - The rest of the command line after "scene"
+ */
+static void console_scene_command(char *arguments){
+
+	/**
+	 * Used to hold the scene, how it is blended and parse position
+	 */
+	const scene_t *scene = NULL;
+	scene_blend_t scene_blend = scene_blend_none;
+	long blend_amount = UINT8_MAX;
+	char *next = arguments;
+
+
+
+	/**
+	 * Print whether a scene is playing, or stop it
+	 */
+	if(*next == '\0'){
+		printf("SCENE %s\r\n", scene_active ? "playing" : "stopped");
+		return;
+	}
+	if(match_console_word(&next, "stop")){
+		stop_scene();
+		printf("SCENE ok\r\n");
+		return;
+	}
+
+
+
+	/**
+	 * Otherwise the scene to play, then optionally how it is blended and,
+	 * to mix, how much of the scene to use
+	 */
+	for(uint32_t i = 0; i < (sizeof(console_scenes) / sizeof(console_scenes[0])); i++){
+		if(match_console_word(&next, console_scenes[i].name)){
+			scene = console_scenes[i].scene;
+			break;
+		}
+	}
+	if(scene == NULL){
+		printf("SCENE error: unknown scene\r\n");
+		return;
+	}
+	while(*next == ' '){
+		next++;
+	}
+	if(*next != '\0'){
+		for(scene_blend = scene_blend_none; scene_blend <= scene_blend_multiply; scene_blend++){
+			if(match_console_word(&next, console_blends[scene_blend])){
+				break;
+			}
+		}
+		if(scene_blend > scene_blend_multiply){
+			printf("SCENE error: unknown blend\r\n");
+			return;
+		}
+		if((scene_blend == scene_blend_mix) && (parse_console_number(&next, 0, UINT8_MAX, &blend_amount) != EXIT_SUCCESS)){
+			printf("SCENE error: mix takes an amount of 0-255\r\n");
+			return;
+		}
+	}
+	printf("SCENE %s\r\n", (start_scene(scene, scene_blend, (uint8_t)blend_amount) == EXIT_SUCCESS) ? "ok" : "error: a fade is running");
+}
+
+
+
+/**
+ * @brief	Handle a sampling command
+ * @param	arguments - The rest of the command line after "sample"
+ */
+static void console_sample_command(char *arguments){
+
+	/**
+	 * Print how samples are acquired, otherwise switch between the LPTMR
+	 * and INT1
+	 */
+	if(*arguments == '\0'){
+		printf("SAMPLE %s\r\n", timed_sampling_active ? "timed" : "int1");
+	}
+	else if(match_console_word(&arguments, "timed")){
+		printf("SAMPLE %s\r\n", (start_timed_sampling() == EXIT_SUCCESS) ? "ok" : "error: the LPTMR is unavailable");
+	}
+	else if(match_console_word(&arguments, "int1")){
+		stop_timed_sampling();
+		printf("SAMPLE ok\r\n");
+	}
+	else{
+		printf("SAMPLE error: unknown command\r\n");
+	}
+}
+
+
+
+/**
+ * @brief	The console commands, by the first word of their line
+ */
+static const console_command_t console_commands[] = {
+	{.name = "cal", .handle = handle_calibration_command},
+	{.name = "orient", .handle = console_orient_command},
+	{.name = "curve", .handle = console_curve_command},
+	{.name = "map", .handle = console_map_command},
+	{.name = "fade", .handle = console_fade_command},
+	{.name = "scene", .handle = console_scene_command},
+	{.name = "sample", .handle = console_sample_command}
+};
+
+
+
+/**
+ * @brief	Handle one complete command line
+ * @param	line - The null-terminated command line
+ * @detail
+ * 		Lines that do not start with a known command are ignored
+ */
+static void console_command(char *line){
+
+	/**
+	 * Used to hold the parse position
+	 */
+	char *next;
+
+
+
+	/**
+	 * Hand the rest of the line to the matching command, without its
+	 * leading spaces
+	 */
+	for(uint32_t i = 0; i < (sizeof(console_commands) / sizeof(console_commands[0])); i++){
+		next = line;
+		if(match_console_word(&next, console_commands[i].name)){
+			while(*next == ' '){
+				next++;
+			}
+			console_commands[i].handle(next);
+			return;
+		}
+	}
+}
+
+
+
+void init_console(void){
+
+	/**
+	 * Interrupt on each received character and on overrun, at the event
+	 * priority. Transmitting is left polled for the debug console
+	 */
+	UART0->C3 |= UART0_C3_ORIE_MASK;
+	UART0->C2 |= UART0_C2_RIE_MASK;
+	NVIC_SetPriority(UART0_IRQn, SCHEDULER_EVENT_PRIORITY);
+	NVIC_ClearPendingIRQ(UART0_IRQn);
+	NVIC_EnableIRQ(UART0_IRQn);
+}
+
+
+
+void UART0_IRQHandler(void){
+
+	/**
+	 * Push each received character as an event
+	 */
+	while(UART0->S1 & UART0_S1_RDRF_MASK){
+		push_event(event_uart_byte, UART0->D);
+	}
+
+
+
+	/**
+	 * Clear an overrun so reception carries on after a long printf
+	 */
+	if(UART0->S1 & UART0_S1_OR_MASK){
+		UART0->S1 = UART0_S1_OR_MASK;
+	}
+}
+
+
+
+void receive_console_char(char received){
+
+	/**
+	 * Gather characters into a line, and handle it once complete
+	 */
+	if((received == '\r') || (received == '\n')){
+		if(console_line_length > 0){
+			console_line[console_line_length] = '\0';
+			console_command(console_line);
+			console_line_length = 0;
+		}
+	}
+	else if(console_line_length < (CONSOLE_LINE_SIZE - 1)){
+		console_line[console_line_length++] = received;
+	}
+}
@@ -0,0 +1,97 @@
+/**
+ * @file	console.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function headers for the debug UART console
+ */
+
+
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+
+
+/**
+ * @brief	Interrupt on each character received over the debug UART, pushing
+ * 			it as an event_uart_byte (see scheduler.h)
+ */
+void init_console(void);
+
+
+
+/**
+ * @brief	Handle console commands received over the debug UART
+ * @param	received - The next character received
+ * @detail
+ * 		Never blocks: characters are gathered into a line, and a complete
+ * 		line is handled as one of:
+ *
+ * 		cal ...					Calibrate the LED colors (see calibration.h)
+ *
+ * 		orient					Print the current mounting orientation
+ * 		orient row <r> <a> <b> <c>
+ * 								Set row r (fixture x, y or z) of the
+ * 								orientation matrix to a, b and c in Q14
+ * 		orient identity			Reset to the identity orientation
+ * 		orient save				Save the current orientation to flash
+ *
+ * 		curve <colors> <type> [<parameter>]
+ * 								Set the response curve of any of r, g and b
+ * 								(e.g. rgb) to linear, gamma <Q8>, scurve
+ * 								<0-256>, deadzone <0-127> or piecewise
+ * 								<input> <output> ... of up to CURVE_MAX_KNOTS
+ * 								knots in 0-255
+ *
+ * 		map						Print how XYZ values are mapped to RGB levels
+ * 		map <mode>				Map by axis, motion, curve or hsv
+ *
+ * 		fade <colors> <start> <end> <ms> [<curve>]
+ * 								Fade any of r, g and b from one level to
+ * 								another, linear, in, out or inout. The
+ * 								pipeline is held off the LEDs meanwhile
+ *
+ * 		scene					Print whether a scene is playing
+ * 		scene <name> [<blend>]	Play breathing, cycle or alert, blended with
+ * 								the tilt color by none, mix <0-255> or
+ * 								multiply
+ * 		scene stop				Stop the scene, handing the LEDs back
+ *
+ * 		sample					Print how samples are acquired
+ * 		sample timed			Pace samples with the LPTMR at SAMPLING_HZ
+ * 		sample int1				Take each sample on accelerometer INT1
+ *
+ * 		Changes take effect on the next RGB update or sample block, so a
+ * 		color or mounting can be trimmed by eye before it is saved
+ */
+void receive_console_char(char received);
+
+
+
+/**
+ * @brief	Parse the next number of a command line, which must be in range
+ * @param	next - The parse position, moved past the number
+ * @param	min - The smallest value accepted
+ * @param	max - The largest value accepted
+ * @param	value - Where to store the number
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if there is no number or it is out
+ * 			of range
+ * @detail
+ * 		The number is range checked as a long before it is narrowed, so an
+ * 		entry too large for its field is rejected instead of wrapping
+ */
+int parse_console_number(char **next, long min, long max, long *value);
+
+
+
+/**
+ * @brief	Match the next word of a command line
+ * @param	next - The parse position, moved past the word if it matches
+ * @param	word - The word to match
+ * @return	true if the next word is word, otherwise false
+ */
+bool match_console_word(char **next, const char *word);
+
+
+
+#endif /* CONSOLE_H_ */
@@ -0,0 +1,414 @@
+/**
+ * @file	curve.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for axis-to-brightness response curves
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdlib.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "bitops.h"
+#include "led.h"		// Keep led.h included before mma8451q.h for led_color_t typedef
+#include "pipeline.h"	// Keep pipeline.h included before mma8451q.h for sample_block_t typedef
+#include "mma8451q.h"
+#include "curve.h"
+#include "tpm.h"
+
+
+
+/**
+ * @brief	1.0 in Q16, the format curves are built in
+ */
+#define CURVE_ONE_Q16\
+	(MASK(1UL, 16))
+
+
+
+/**
+ * @brief	The amount of offset XYZ values covered by each segment is
+ * 			2^CURVE_SEGMENT_SHIFT. Folded to a constant by the compiler
+ */
+#define CURVE_SEGMENT_SHIFT\
+	(__builtin_ctz((XYZ_LEVELS) / (CURVE_SEGMENTS)))
+
+
+
+/**
+ * @brief	Mask for the position of an offset XYZ value within its segment
+ */
+#define CURVE_SEGMENT_MASK\
+	((MASK(1UL, CURVE_SEGMENT_SHIFT)) - 1)
+
+
+
+/**
+ * @brief	2^(2^-i) for i = 1 to 16 in Q30, used to raise 2 to a fractional
+ * 			power one bit at a time
+ */
+static const uint32_t curve_exp2_table[16] = {
+	1518500250,		// 2^(1/2)
+	1276901417,		// 2^(1/4)
+	1170923762,		// 2^(1/8)
+	1121280436,		// 2^(1/16)
+	1097253708,		// 2^(1/32)
+	1085434106,		// 2^(1/64)
+	1079572136,		// 2^(1/128)
+	1076653033,		// 2^(1/256)
+	1075196443,		// 2^(1/512)
+	1074468888,		// 2^(1/1024)
+	1074105294,		// 2^(1/2048)
+	1073923544,		// 2^(1/4096)
+	1073832680,		// 2^(1/8192)
+	1073787251,		// 2^(1/16384)
+	1073764537,		// 2^(1/32768)
+	1073753181		// 2^(1/65536)
+};
+
+
+
+/**
+ * @brief	Two tables per LED color. One is in use while the other is rebuilt
+ */
+static curve_table_t curve_tables[CURVE_CHANNELS][2];
+
+
+
+/**
+ * @brief	The table currently in use for each LED color. Swapping a curve is
+ * 			a single aligned pointer store, which is atomic on Cortex-M0+
+ */
+static const curve_table_t * volatile active_curve[CURVE_CHANNELS];
+
+
+
+/**
+ * @brief	Raise a value between 0 and 1 to a power
+ * @param	t - The base in Q16, between 0 and CURVE_ONE_Q16
+ * @param	exponent_q8 - The exponent in Q8
+ * @return	t^exponent in Q16
+ * @detail
+ * 		Computed as 2^(exponent * log2(t)) with integer-only math. Only used
+ * 		while building a table, never per sample
+ */
+static uint32_t curve_power(uint32_t t, uint32_t exponent_q8){
+
+	/**
+	 * Used to hold log2(t), its mantissa and the exponent of 2 to raise
+	 */
+	int32_t log2_t;
+	uint64_t mantissa;
+	int32_t power;
+	uint32_t whole;
+	uint32_t fraction;
+	uint64_t result;
+	int n;
+
+
+
+	/**
+	 * Handle the ends of the range directly
+	 */
+	if(t == 0){
+		return 0;
+	}
+	if(t >= CURVE_ONE_Q16){
+		return CURVE_ONE_Q16;
+	}
+
+
+
+	/**
+	 * Integer part of log2, then normalize the mantissa to [1, 2) in Q16
+	 */
+	n = 31 - __builtin_clz(t);
+	log2_t = (n - 16) * (int32_t)CURVE_ONE_Q16;
+	mantissa = ((uint64_t)t << 16) >> n;
+
+
+
+	/**
+	 * Fractional part of log2, one bit per squaring
+	 */
+	for(int i = 1; i <= 16; i++){
+		mantissa = (mantissa * mantissa) >> 16;
+		if(mantissa >= (2 * CURVE_ONE_Q16)){
+			mantissa >>= 1;
+			log2_t += (int32_t)MASK(1UL, 16 - i);
+		}
+	}
+
+
+
+	/**
+	 * Scale by the exponent. log2_t is negative, so power is too
+	 */
+	power = (int32_t)(((int64_t)log2_t * (int64_t)exponent_q8) >> 8);
+
+
+
+	/**
+	 * Split -power into a whole shift and a fraction, where
+	 * 2^power = 2^fraction / 2^whole
+	 */
+	whole = (uint32_t)((-power + (int32_t)(CURVE_ONE_Q16 - 1)) >> 16);
+	fraction = (uint32_t)(power + (int32_t)(whole << 16));
+	if(whole > 16){
+		return 0;
+	}
+
+
+
+	/**
+	 * Raise 2 to the fraction one bit at a time in Q30
+	 */
+	result = MASK(1UL, 30);
+	for(int i = 0; i < 16; i++){
+		if(fraction & MASK(1UL, 15 - i)){
+			result = (result * curve_exp2_table[i]) >> 30;
+		}
+	}
+
+	return ((uint32_t)((result >> 14) >> whole));
+}
+
+
+
+/**
+ * @brief	Calculate a curve at a single point
+ * @param	curve_config - The curve to calculate
+ * @param	t - The normalized input in Q16, between 0 and CURVE_ONE_Q16
+ * @return	The normalized output in Q16, between 0 and CURVE_ONE_Q16
+ */
+static uint32_t curve_point(const curve_config_t *curve_config, uint32_t t){
+
+	/**
+	 * Used to hold intermediate values for the different curve shapes
+	 */
+	uint32_t center = (CURVE_ONE_Q16 / 2);
+	uint32_t width;
+	uint32_t t2, t3, smooth;
+	uint32_t x, x0, x1, y0, y1;
+	int k;
+
+
+
+	switch(curve_config->type){
+	case curve_gamma:
+		return (curve_power(t, curve_config->parameter));
+
+	case curve_s_curve:
+
+		/**
+		 * Smoothstep 3t^2 - 2t^3, blended with linear by strength
+		 */
+		t2 = (uint32_t)(((uint64_t)t * t) >> 16);
+		t3 = (uint32_t)(((uint64_t)t2 * t) >> 16);
+		smooth = (3 * t2) - (2 * t3);
+		return ((uint32_t)((int32_t)t + ((((int32_t)smooth - (int32_t)t) * (int32_t)curve_config->parameter) >> 8)));
+
+	case curve_dead_zone:
+
+		/**
+		 * Hold at the center while within the zone, linear outside of it
+		 */
+		width = ((uint32_t)curve_config->parameter << 8);
+		if(width >= center){
+			return (center);
+		}
+		if(t < (center - width)){
+			return ((uint32_t)(((uint64_t)t * center) / (center - width)));
+		}
+		if(t > (center + width)){
+			return (center + (uint32_t)(((uint64_t)(t - center - width) * (CURVE_ONE_Q16 - center)) / (CURVE_ONE_Q16 - center - width)));
+		}
+		return (center);
+
+	case curve_piecewise:
+
+		/**
+		 * Work in 0-255 knot units scaled by 2^16, clamping outside the knots
+		 */
+		x = (t * 255);
+		if(x <= ((uint32_t)curve_config->knots[0].input << 16)){
+			return (((uint32_t)curve_config->knots[0].output << 16) / 255);
+		}
+		for(k = 1; k < curve_config->knot_count; k++){
+			x1 = ((uint32_t)curve_config->knots[k].input << 16);
+			if(x <= x1){
+				x0 = ((uint32_t)curve_config->knots[k - 1].input << 16);
+				y0 = ((uint32_t)curve_config->knots[k - 1].output << 16);
+				y1 = ((uint32_t)curve_config->knots[k].output << 16);
+				if(y1 >= y0){
+					return ((y0 + (uint32_t)(((uint64_t)(y1 - y0) * (x - x0)) / (x1 - x0))) / 255);
+				}
+				return ((y0 - (uint32_t)(((uint64_t)(y0 - y1) * (x - x0)) / (x1 - x0))) / 255);
+			}
+		}
+		return (((uint32_t)curve_config->knots[curve_config->knot_count - 1].output << 16) / 255);
+
+	case curve_linear:
+	default:
+		return (t);
+	}
+}
+
+
+
+/**
+ * @brief	Look up an offset XYZ value in a curve table
+ * @param	table - The curve table
+ * @param	input - Offset XYZ value between 0 and XYZ_LEVELS - 1
+ * @return	The RGB level
+ */
+static inline int16_t curve_lookup(const curve_table_t *table, uint32_t input){
+
+	/**
+	 * Used to hold the segment and position within the segment
+	 */
+	uint32_t segment = (input >> CURVE_SEGMENT_SHIFT);
+	int32_t position = (input & CURVE_SEGMENT_MASK);
+
+
+
+	/**
+	 * Interpolate within the segment and drop the fractional bits
+	 */
+	return ((int16_t)((table->base[segment] + ((table->delta[segment] * position) >> CURVE_SEGMENT_SHIFT)) >> CURVE_OUTPUT_SHIFT));
+}
+
+
+
+void init_curves(void){
+
+	/**
+	 * Used to hold the default curve
+	 */
+	curve_config_t linear = {
+		.type = curve_linear
+	};
+
+
+
+	/**
+	 * Start every LED color with a linear curve
+	 */
+	set_curve(red, &linear);
+	set_curve(green, &linear);
+	set_curve(blue, &linear);
+}
+
+
+
+int set_curve(led_color_t led_color, const curve_config_t *curve_config){
+
+	/**
+	 * Used to hold the table being built and the outputs at each end of
+	 * the current segment
+	 */
+	curve_table_t *table;
+	int32_t start, end;
+
+
+
+	/**
+	 * Validate the LED color and curve
+	 */
+	if(((led_color != red) && (led_color != green) && (led_color != blue)) || (curve_config == NULL)){
+		return EXIT_FAILURE;
+	}
+	if(((curve_config->type == curve_gamma) && (curve_config->parameter > CURVE_GAMMA_MAX_Q8)) ||
+		((curve_config->type == curve_s_curve) && (curve_config->parameter > CURVE_S_CURVE_MAX)) ||
+		((curve_config->type == curve_dead_zone) && (curve_config->parameter > CURVE_DEAD_ZONE_MAX))){
+		return EXIT_FAILURE;
+	}
+	if(curve_config->type == curve_piecewise){
+		if((curve_config->knot_count < 2) || (curve_config->knot_count > CURVE_MAX_KNOTS)){
+			return EXIT_FAILURE;
+		}
+		for(int k = 1; k < curve_config->knot_count; k++){
+			if(curve_config->knots[k].input <= curve_config->knots[k - 1].input){
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+
+
+	/**
+	 * Build into whichever table is not currently in use
+	 */
+	table = &curve_tables[LED_CHANNEL_INDEX(led_color)][0];
+	if(active_curve[LED_CHANNEL_INDEX(led_color)] == table){
+		table = &curve_tables[LED_CHANNEL_INDEX(led_color)][1];
+	}
+
+
+
+	/**
+	 * Calculate the curve at both ends of every segment and store the start
+	 * and change across it, scaled to RGB levels
+	 */
+	end = (int32_t)((((uint64_t)curve_point(curve_config, 0) * (RGB_MAX << CURVE_OUTPUT_SHIFT)) + (CURVE_ONE_Q16 / 2)) >> 16);
+	for(int s = 0; s < CURVE_SEGMENTS; s++){
+		start = end;
+		end = (int32_t)((((uint64_t)curve_point(curve_config, ((uint32_t)(s + 1) * CURVE_ONE_Q16) / CURVE_SEGMENTS) * (RGB_MAX << CURVE_OUTPUT_SHIFT)) + (CURVE_ONE_Q16 / 2)) >> 16);
+		table->base[s] = (int16_t)start;
+		table->delta[s] = (int16_t)(end - start);
+	}
+
+
+
+	/**
+	 * Swap the new table in
+	 */
+	active_curve[LED_CHANNEL_INDEX(led_color)] = table;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+int16_t evaluate_curve(led_color_t led_color, uint16_t input){
+
+	return (curve_lookup(active_curve[LED_CHANNEL_INDEX(led_color)], input));
+}
+
+
+
+void calculate_rgb_block_from_curve(const sample_block_t *sample_block, rgb_block_t *rgb_block){
+
+	/**
+	 * Take each table once per block, so a curve swapped mid-block only
+	 * applies from the next block
+	 */
+	const curve_table_t *red_table = active_curve[LED_CHANNEL_INDEX(red)];
+	const curve_table_t *green_table = active_curve[LED_CHANNEL_INDEX(green)];
+	const curve_table_t *blue_table = active_curve[LED_CHANNEL_INDEX(blue)];
+
+
+
+	/**
+	 * Map each axis through its curve in its own tight loop
+	 */
+	for(int i = 0; i < sample_block->count; i++){
+		rgb_block->red[i] = curve_lookup(red_table, (uint32_t)(sample_block->x[i] + XYZ_OFFSET));
+	}
+	for(int i = 0; i < sample_block->count; i++){
+		rgb_block->green[i] = curve_lookup(green_table, (uint32_t)(sample_block->y[i] + XYZ_OFFSET));
+	}
+	for(int i = 0; i < sample_block->count; i++){
+		rgb_block->blue[i] = curve_lookup(blue_table, (uint32_t)(sample_block->z[i] + XYZ_OFFSET));
+	}
+	rgb_block->count = sample_block->count;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file	curve.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros and function headers for axis-to-brightness response curves
+ */
+
+
+
+#ifndef CURVE_H_
+#define CURVE_H_
+
+
+
+/**
+ * @brief	The amount of LED colors that can each have their own curve
+ * 			(red, green and blue)
+ */
+#define CURVE_CHANNELS\
+	(3)
+
+
+
+/**
+ * @brief	The amount of equal-width segments each curve is split into. Must
+ * 			be a power of two that divides XYZ_LEVELS
+ */
+#define CURVE_SEGMENTS\
+	(32)
+
+
+
+/**
+ * @brief	Segment outputs are stored scaled up by 2^CURVE_OUTPUT_SHIFT so
+ * 			interpolation within a segment keeps its fractional bits
+ */
+#define CURVE_OUTPUT_SHIFT\
+	(4)
+
+
+
+/**
+ * @brief	The most knots a user-defined piecewise-linear curve can have
+ */
+#define CURVE_MAX_KNOTS\
+	(8)
+
+
+
+/**
+ * @brief	The largest parameter of each curve type that takes one: gamma 8.0
+ * 			in Q8, full smoothstep, and a dead zone just short of the whole
+ * 			range
+ */
+#define CURVE_GAMMA_MAX_Q8\
+	(2048)
+#define CURVE_S_CURVE_MAX\
+	(256)
+#define CURVE_DEAD_ZONE_MAX\
+	(127)
+
+
+
+/**
+ * @brief	Used to select the shape of a response curve
+ * @detail
+ * 		curve_linear:		Output follows input
+ * 		curve_gamma:		Output = input^gamma, where parameter is gamma in
+ * 							Q8 (e.g. 563 for 2.2)
+ * 		curve_s_curve:		Smoothstep, where parameter is the strength
+ * 							between 0 (linear) and 256 (full smoothstep)
+ * 		curve_dead_zone:	Output holds at mid-level while input is within
+ * 							parameter/256 of the middle of the range, and is
+ * 							linear outside of that
+ * 		curve_piecewise:	Linear between user-defined knots
+ */
+typedef enum curve_type_e{
+	curve_linear,
+	curve_gamma,
+	curve_s_curve,
+	curve_dead_zone,
+	curve_piecewise
+} curve_type_t;
+
+
+
+/**
+ * @brief	A knot of a piecewise-linear curve. Both input and output are
+ * 			normalized to 0-255 regardless of the XYZ and RGB ranges
+ */
+typedef struct curve_knot_s{
+	uint8_t input;
+	uint8_t output;
+} curve_knot_t;
+
+
+
+/**
+ * @brief	Describes a response curve before it is built into a segment table
+ * @detail
+ * 		knot_count and knots are only used by curve_piecewise. Knot inputs
+ * 		must be strictly increasing
+ */
+typedef struct curve_config_s{
+	curve_type_t type;
+	uint16_t parameter;
+	uint8_t knot_count;
+	curve_knot_t knots[CURVE_MAX_KNOTS];
+} curve_config_t;
+
+
+
+/**
+ * @brief	A curve built into equal-width segments, where each segment holds
+ * 			its starting output and the change in output across the segment.
+ * 			Outputs are RGB levels scaled up by 2^CURVE_OUTPUT_SHIFT
+ */
+typedef struct curve_table_s{
+	int16_t base[CURVE_SEGMENTS];
+	int16_t delta[CURVE_SEGMENTS];
+} curve_table_t;
+
+
+
+/**
+ * @brief	Build a linear curve for every LED color
+ */
+void init_curves(void);
+
+
+
+/**
+ * @brief	Build and switch to a new curve for an LED color
+ * @param	led_color - The LED color (red, green or blue) to set the curve of
+ * @param	curve_config - The curve to build
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if the parameter is beyond the
+ * 			maximum of its curve type or the knots are invalid
+ * @detail
+ * 		The curve is built into a second table while the current one stays in
+ * 		use, and then swapped in with a single pointer store. The render loop
+ * 		never sees a half-built curve and never waits for one
+ */
+int set_curve(led_color_t led_color, const curve_config_t *curve_config);
+
+
+
+/**
+ * @brief	Evaluate the curve of an LED color
+ * @param	led_color - The LED color (red, green or blue) to evaluate
+ * @param	input - Offset XYZ value between 0 and XYZ_LEVELS - 1
+ * @return	The RGB level
+ * @detail
+ * 		O(1): one segment lookup, one multiply and two shifts
+ */
+int16_t evaluate_curve(led_color_t led_color, uint16_t input);
+
+
+
+/**
+ * @brief	Map a block of XYZ samples through the red, green and blue curves
+ * 			with x to red, y to green and z to blue
+ * @param	sample_block - The block to map from
+ * @param	rgb_block - The block to map to
+ */
+void calculate_rgb_block_from_curve(const sample_block_t *sample_block, rgb_block_t *rgb_block);
+
+
+
+#endif /* CURVE_H_ */
@@ -0,0 +1,146 @@
+/**
+ * @file	deferred.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for work deferred from interrupts to PendSV
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "bitops.h"
+#include "deferred.h"
+#include "timebase.h"
+
+
+
+/**
+ * @brief	The handler of each kind of work
+ */
+static void (*deferred_handlers[deferred_work_count])(void) = {NULL};
+
+
+
+/**
+ * @brief	One bit per kind of work waiting for PendSV, and when each was
+ * 			first deferred
+ */
+static volatile uint32_t deferred_pending = 0;
+static volatile uint32_t deferred_at[deferred_work_count];
+
+
+
+/**
+ * @brief	The latency from defer_work() to the handler starting, in us
+ */
+static latency_t deferred_latency = {0};
+
+
+
+void init_deferred_work(void){
+
+	NVIC_SetPriority(PendSV_IRQn, DEFERRED_PRIORITY);
+}
+
+
+
+void set_deferred_handler(deferred_work_t work, void (*handler)(void)){
+
+	deferred_handlers[work] = handler;
+}
+
+
+
+void defer_work(deferred_work_t work){
+
+	/**
+	 * Used to set the pending bit without an interrupt in between, since the
+	 * Cortex-M0+ has no exclusive load/store
+	 */
+	uint32_t irq_mask;
+
+	irq_mask = DisableGlobalIRQ();
+	if((deferred_pending & MASK(1UL, work)) == 0){
+		deferred_at[work] = get_timebase_us32();
+		deferred_pending |= MASK(1UL, work);
+	}
+	EnableGlobalIRQ(irq_mask);
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+
+
+void PendSV_Handler(void){
+
+	/**
+	 * Used to hold the work taken to run
+	 */
+	uint32_t irq_mask;
+	uint32_t pending;
+	uint32_t at[deferred_work_count];
+
+
+
+	/**
+	 * Take everything pending at once, then run it in deferred_work_t order.
+	 * Work deferred meanwhile is picked up by going round again
+	 */
+	while(1){
+		irq_mask = DisableGlobalIRQ();
+		pending = deferred_pending;
+		deferred_pending = 0;
+		for(uint8_t work = 0; work < deferred_work_count; work++){
+			at[work] = deferred_at[work];
+		}
+		EnableGlobalIRQ(irq_mask);
+		if(pending == 0){
+			return;
+		}
+
+		for(uint8_t work = 0; work < deferred_work_count; work++){
+			if((pending & MASK(1UL, work)) == 0){
+				continue;
+			}
+			record_latency(&deferred_latency, get_timebase_us32() - at[work]);
+			if(deferred_handlers[work] != NULL){
+				deferred_handlers[work]();
+			}
+		}
+	}
+}
+
+
+
+void get_deferred_latency(latency_t *latency){
+
+	/**
+	 * Used to copy the statistics out without PendSV in between
+	 */
+	uint32_t irq_mask;
+
+	irq_mask = DisableGlobalIRQ();
+	*latency = deferred_latency;
+	EnableGlobalIRQ(irq_mask);
+}
+
+
+
+void record_latency(latency_t *latency, uint32_t value){
+
+	latency->count++;
+	latency->total += value;
+	if(value > latency->max){
+		latency->max = value;
+	}
+}
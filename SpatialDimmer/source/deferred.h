@@ -0,0 +1,114 @@
+/**
+ * @file	deferred.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros, types and function headers for work deferred from
+ * 			interrupts to PendSV
+ */
+
+
+
+#ifndef DEFERRED_H_
+#define DEFERRED_H_
+
+
+
+/**
+ * @brief	The NVIC priority of the interrupts doing urgent work: acquisition
+ * 			triggers, which stamp and read each sample themselves. Above
+ * 			SysTick, PendSV and the event interrupts, below the PWM and DMA
+ * 			interrupts at priority 0
+ */
+#define DEFERRED_URGENT_PRIORITY\
+	(1)
+
+
+
+/**
+ * @brief	The priority of PendSV, the lowest. It still preempts the main
+ * 			loop, and sits below SysTick so deferred work that stalls cannot
+ * 			hold up task supervision (see scheduler.h)
+ */
+#define DEFERRED_PRIORITY\
+	((1UL << __NVIC_PRIO_BITS) - 1UL)
+
+
+
+/**
+ * @brief	The work that can be deferred, in the order PendSV runs it when
+ * 			several are pending
+ * @detail
+ * 		deferred_scene:		Step the playing scene (see scene.h)
+ */
+typedef enum deferred_work_e{
+	deferred_scene,
+	deferred_work_count
+} deferred_work_t;
+
+
+
+/**
+ * @brief	Running statistics of a latency
+ * @detail
+ * 		count:	How many latencies were recorded
+ * 		max:	The longest
+ * 		total:	The sum, for the average
+ */
+typedef struct latency_s{
+	uint32_t count;
+	uint32_t max;
+	uint64_t total;
+} latency_t;
+
+
+
+/**
+ * @brief	Give PendSV its priority
+ */
+void init_deferred_work(void);
+
+
+
+/**
+ * @brief	Set the handler PendSV runs for a kind of work
+ * @param	work - The kind of work
+ * @param	handler - Called from PendSV each time the work is deferred. Runs
+ * 			to completion, but can be preempted by every other interrupt
+ */
+void set_deferred_handler(deferred_work_t work, void (*handler)(void));
+
+
+
+/**
+ * @brief	Ask PendSV to run a kind of work once the interrupts above it are
+ * 			done
+ * @param	work - The kind of work
+ * @detail
+ * 		Safe from any context. Deferring work already pending runs it once,
+ * 		so a handler must catch up on everything outstanding
+ */
+void defer_work(deferred_work_t work);
+
+
+
+/**
+ * @brief	Read the latency from defer_work() to PendSV starting the work
+ * @param	latency - Where to copy the statistics out to, in us
+ */
+void get_deferred_latency(latency_t *latency);
+
+
+
+/**
+ * @brief	Add a latency to running statistics
+ * @param	latency - The statistics to add to
+ * @param	value - The latency
+ * @detail
+ * 		Not atomic: record into a latency from one context only, and copy it
+ * 		out with interrupts masked
+ */
+void record_latency(latency_t *latency, uint32_t value);
+
+
+
+#endif /* DEFERRED_H_ */
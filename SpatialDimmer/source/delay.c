@@ -0,0 +1,125 @@
+/**
+ * @file	delay.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for timed delays and deadlines
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "delay.h"
+
+
+
+/**
+ * @brief	Core clock cycles per microsecond, rounded up so delays are never
+ * 			short
+ */
+#define DELAY_CYCLES_PER_US\
+	((SystemCoreClock + 999999UL) / 1000000UL)
+
+
+
+/**
+ * @brief	The longest delay_us() or deadline in microseconds, which keeps
+ * 			the cycle count within 32 bits up to 4 GHz
+ */
+#define DELAY_MAX_US\
+	(1000000UL)
+
+
+
+/**
+ * @brief	Make sure SysTick is counting
+ * @detail
+ * 		Before the scheduler starts SysTick it is started free-running from
+ * 		its largest reload value without an interrupt, like benchmark_start().
+ * 		A running SysTick is left untouched
+ */
+static inline void delay_start_systick(void){
+
+	if((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0){
+		SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+		SysTick->VAL = 0;
+		SysTick->CTRL =
+			SysTick_CTRL_CLKSOURCE_Msk |
+			SysTick_CTRL_ENABLE_Msk;
+	}
+}
+
+
+
+void start_deadline(deadline_t *deadline, uint32_t us){
+
+	if(us > DELAY_MAX_US){
+		us = DELAY_MAX_US;
+	}
+	delay_start_systick();
+	deadline->last = SysTick->VAL;
+	deadline->remaining = us * DELAY_CYCLES_PER_US;
+}
+
+
+
+bool deadline_expired(deadline_t *deadline){
+
+	/**
+	 * Used to hold the SysTick value now and the cycles since last polled
+	 */
+	uint32_t now = SysTick->VAL;
+	uint32_t elapsed;
+
+
+
+	/**
+	 * SysTick counts down and wraps from 0 to LOAD
+	 */
+	if(now <= deadline->last){
+		elapsed = deadline->last - now;
+	}
+	else{
+		elapsed = deadline->last + (SysTick->LOAD + 1) - now;
+	}
+	deadline->last = now;
+
+	if(elapsed >= deadline->remaining){
+		deadline->remaining = 0;
+		return true;
+	}
+	deadline->remaining -= elapsed;
+
+	return false;
+}
+
+
+
+void delay_us(uint32_t us){
+
+	/**
+	 * Used to time the delay
+	 */
+	deadline_t deadline;
+
+	start_deadline(&deadline, us);
+	while(!deadline_expired(&deadline));
+}
+
+
+
+void delay_ms(uint32_t ms){
+
+	while(ms-- > 0){
+		delay_us(1000);
+	}
+}
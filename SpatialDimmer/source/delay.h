@@ -0,0 +1,69 @@
+/**
+ * @file	delay.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Types and function headers for timed delays and deadlines
+ */
+
+
+
+#ifndef DELAY_H_
+#define DELAY_H_
+
+
+
+/**
+ * @brief	A point in time to poll against, for bounding waits on hardware
+ * @detail
+ * 		last:		The SysTick value when the deadline was last polled
+ * 		remaining:	Core clock cycles left until the deadline
+ */
+typedef struct deadline_s{
+	uint32_t last;
+	uint32_t remaining;
+} deadline_t;
+
+
+
+/**
+ * @brief	Wait a number of microseconds
+ * @param	us - The microseconds to wait, up to 1000000
+ * @detail
+ * 		Timed by SysTick from SystemCoreClock, so the wait holds across clock
+ * 		configurations and optimization levels. Never shorter than asked,
+ * 		and longer only by interrupts taken while waiting
+ */
+void delay_us(uint32_t us);
+
+
+
+/**
+ * @brief	Wait a number of milliseconds
+ * @param	ms - The milliseconds to wait
+ */
+void delay_ms(uint32_t ms);
+
+
+
+/**
+ * @brief	Start a deadline some microseconds from now
+ * @param	deadline - The deadline to start
+ * @param	us - The microseconds until the deadline, up to 1000000
+ */
+void start_deadline(deadline_t *deadline, uint32_t us);
+
+
+
+/**
+ * @brief	Check whether a deadline has passed
+ * @param	deadline - The deadline to check
+ * @return	true once the deadline has passed, otherwise false
+ * @detail
+ * 		Time is counted between calls, so poll at least once per SysTick
+ * 		period (10 ms once the scheduler runs)
+ */
+bool deadline_expired(deadline_t *deadline);
+
+
+
+#endif /* DELAY_H_ */
@@ -0,0 +1,305 @@
+/**
+ * @file	fade.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for DMA-driven LED fades
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include "board.h"
+#include "fsl_clock.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "bitops.h"
+#include "calibration.h"
+#include "led.h"		// Keep led.h included before fade.h for led_color_t typedef
+#include "fade.h"
+#include "scene.h"
+#include "tpm.h"
+
+
+
+/**
+ * @brief	The DMAMUX request source for TPM1 overflow
+ */
+#define FADE_DMAMUX_SOURCE\
+	(55)
+
+
+
+/**
+ * @brief	The largest TPM prescaler exponent (divide by 2^7)
+ */
+#define FADE_MAX_PRESCALER\
+	(7)
+
+
+
+/**
+ * @brief	The DMA channels used by a fade, one per LED channel and in the
+ * 			order they are linked
+ */
+#define FADE_RED_DMA_CHANNEL\
+	(0)
+#define FADE_GREEN_DMA_CHANNEL\
+	(1)
+#define FADE_BLUE_DMA_CHANNEL\
+	(2)
+
+
+
+/**
+ * @brief	Set while DMA is streaming a fade into the LED channels
+ */
+volatile bool fade_active = false;
+
+
+
+/**
+ * @brief	The CnV value of each step of the fade, one buffer per DMA
+ * 			channel
+ */
+static uint32_t fade_cnv[3][FADE_MAX_STEPS];
+
+
+
+/**
+ * @brief	The RGB levels each channel ends the fade on
+ */
+static int16_t fade_end_level[3];
+
+
+
+int32_t fade_ease(int32_t t, fade_curve_t fade_curve){
+
+	/**
+	 * Used to hold powers of t and of 1 - t
+	 */
+	int32_t t2;
+	int32_t t3;
+	int32_t u;
+
+	switch(fade_curve){
+	case fade_ease_in:
+		return ((t * t) >> 15);
+	case fade_ease_out:
+		u = FADE_ONE_Q15 - t;
+		return (FADE_ONE_Q15 - ((u * u) >> 15));
+	case fade_ease_in_out:
+		t2 = (t * t) >> 15;
+		t3 = (t2 * t) >> 15;
+		return ((3 * t2) - (2 * t3));
+	case fade_linear:
+	default:
+		return (t);
+	}
+}
+
+
+
+/**
+ * @brief	Stop TPM1 and the fade DMA channels
+ */
+static void fade_stop(void){
+
+	/**
+	 * Stop the step clock and stop routing its requests
+	 */
+	TPM1->SC = 0;
+	DMAMUX0->CHCFG[FADE_RED_DMA_CHANNEL] = 0;
+
+
+
+	/**
+	 * Clear each channel's DONE flag, which also clears any error
+	 */
+	DMA0->DMA[FADE_RED_DMA_CHANNEL].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+	DMA0->DMA[FADE_GREEN_DMA_CHANNEL].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+	DMA0->DMA[FADE_BLUE_DMA_CHANNEL].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+}
+
+
+
+int start_fade(led_color_t led_color, int16_t start_level, int16_t end_level, uint32_t duration_ms, fade_curve_t fade_curve){
+
+	/**
+	 * Used to hold the fade timing and the TPM1 prescaler and MOD it needs
+	 */
+	uint32_t steps;
+	uint32_t counts;
+	uint8_t tpm_sc_ps;
+
+
+
+	/**
+	 * Used to hold which channels fade and the level each holds otherwise
+	 */
+	int16_t hold_level[3] = {current_red_level, current_green_level, current_blue_level};
+	led_color_t led_colors[3] = {red, green, blue};
+	int16_t level[3];
+	uint16_t step_cnv[3];
+	int32_t eased;
+	volatile uint32_t *cnv[3] = {
+		&TPM2->CONTROLS[TPM2_RED_LED_CHANNEL].CnV,
+		&TPM2->CONTROLS[TPM2_GREEN_LED_CHANNEL].CnV,
+		&TPM0->CONTROLS[TPM0_BLUE_LED_CHANNEL].CnV
+	};
+
+
+
+	/**
+	 * A playing scene owns the LEDs until it stops. Otherwise use as many
+	 * steps as fit at FADE_MIN_STEP_MS apart, then find the TPM1 prescaler
+	 * that stretches each step to duration_ms / steps
+	 */
+	if((duration_ms == 0) || (duration_ms > FADE_MAX_DURATION_MS) || scene_active){
+		return EXIT_FAILURE;
+	}
+	steps = duration_ms / FADE_MIN_STEP_MS;
+	if(steps > FADE_MAX_STEPS){
+		steps = FADE_MAX_STEPS;
+	}
+	else if(steps == 0){
+		steps = 1;
+	}
+	counts = ((CLOCK_GetFreq(kCLOCK_PllFllSelClk) / 1000) * duration_ms) / steps;
+	tpm_sc_ps = get_tpm_prescaler(counts, 16);
+	if(tpm_sc_ps > FADE_MAX_PRESCALER){
+		return EXIT_FAILURE;
+	}
+
+
+
+	/**
+	 * Cancel any running fade and keep the TPM0 overflow interrupt from
+	 * overwriting what DMA writes
+	 */
+	SIM->SCGC6 |= SIM_SCGC6_TPM1_MASK | SIM_SCGC6_DMAMUX_MASK;
+	SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+	fade_stop();
+	fade_active = true;
+
+
+
+	/**
+	 * Precompute every step of each channel. Channels that do not fade hold
+	 * their current level for the whole fade. Each step is corrected for
+	 * this board's LEDs and held to the power budget as a whole triple,
+	 * since both look across channels. Step -1 is the start level, written
+	 * straight to CnV
+	 */
+	for(int channel = 0; channel < 3; channel++){
+		fade_end_level[channel] = (led_color & led_colors[channel]) ? end_level : hold_level[channel];
+	}
+	for(int32_t step = -1; step < (int32_t)steps; step++){
+		eased = 0;
+		if(step >= 0){
+			eased = fade_ease((int32_t)(((uint32_t)(step + 1) * FADE_ONE_Q15) / steps), fade_curve);
+		}
+		for(int channel = 0; channel < 3; channel++){
+			level[channel] = hold_level[channel];
+			if(led_color & led_colors[channel]){
+				level[channel] = (int16_t)(start_level + ((((int32_t)(end_level - start_level) * eased) + (FADE_ONE_Q15 / 2)) >> 15));
+			}
+		}
+		calibrate_rgb_levels(&level[0], &level[1], &level[2]);
+		rgb_levels_to_cnv(level, step_cnv);
+		for(int channel = 0; channel < 3; channel++){
+			if(step < 0){
+				*cnv[channel] = step_cnv[channel];
+			}
+			else{
+				fade_cnv[channel][step] = step_cnv[channel];
+			}
+		}
+	}
+
+
+
+	/**
+	 * Configure the DMA channels:
+	 * 	- 32-bit reads from an incrementing source into a fixed CnV register
+	 * 	- One transfer per request (cycle steal)
+	 * 	- Channel 0 is requested by TPM1 overflow and links to channel 1,
+	 * 	  which links to channel 2
+	 * 	- Channel 2 interrupts when its last step is written
+	 */
+	for(int channel = 0; channel < 3; channel++){
+		DMA0->DMA[channel].SAR = (uint32_t)(uintptr_t)fade_cnv[channel];
+		DMA0->DMA[channel].DAR = (uint32_t)(uintptr_t)cnv[channel];
+		DMA0->DMA[channel].DSR_BCR = DMA_DSR_BCR_BCR(steps * sizeof(uint32_t));
+	}
+	DMA0->DMA[FADE_RED_DMA_CHANNEL].DCR =
+		DMA_DCR_ERQ_MASK |
+		DMA_DCR_CS_MASK |
+		DMA_DCR_SINC_MASK |
+		DMA_DCR_SSIZE(0) |
+		DMA_DCR_DSIZE(0) |
+		DMA_DCR_D_REQ_MASK |
+		DMA_DCR_LINKCC(2) |
+		DMA_DCR_LCH1(FADE_GREEN_DMA_CHANNEL);
+	DMA0->DMA[FADE_GREEN_DMA_CHANNEL].DCR =
+		DMA_DCR_CS_MASK |
+		DMA_DCR_SINC_MASK |
+		DMA_DCR_SSIZE(0) |
+		DMA_DCR_DSIZE(0) |
+		DMA_DCR_LINKCC(2) |
+		DMA_DCR_LCH1(FADE_BLUE_DMA_CHANNEL);
+	DMA0->DMA[FADE_BLUE_DMA_CHANNEL].DCR =
+		DMA_DCR_EINT_MASK |
+		DMA_DCR_CS_MASK |
+		DMA_DCR_SINC_MASK |
+		DMA_DCR_SSIZE(0) |
+		DMA_DCR_DSIZE(0);
+	NVIC_EnableIRQ(DMA2_IRQn);
+
+
+
+	/**
+	 * Route TPM1 overflow to channel 0 and start TPM1, requesting DMA
+	 * instead of interrupting on overflow
+	 */
+	DMAMUX0->CHCFG[FADE_RED_DMA_CHANNEL] =
+		DMAMUX_CHCFG_ENBL_MASK |
+		DMAMUX_CHCFG_SOURCE(FADE_DMAMUX_SOURCE);
+	TPM1->CNT = 0;
+	TPM1->MOD = (uint16_t)((counts >> tpm_sc_ps) - 1);
+	TPM1->SC =
+		TPM_SC_PS(tpm_sc_ps) |
+		TPM_SC_DMA_MASK;
+	TPM1->SC |= TPM_SC_CMOD(1);
+
+	return EXIT_SUCCESS;
+}
+
+
+
+void DMA2_IRQHandler(void){
+
+	/**
+	 * The last step of every channel is written, so stop the step clock
+	 */
+	fade_stop();
+
+
+
+	/**
+	 * Publish the end levels and hand the LEDs back to the TPM0 overflow
+	 * interrupt, which commits them on the next period
+	 */
+	current_red_level = fade_end_level[0];
+	current_green_level = fade_end_level[1];
+	current_blue_level = fade_end_level[2];
+	analog_control_onboard_leds(white, analog_set);
+	fade_active = false;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file	fade.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros, types and function headers for DMA-driven LED fades
+ */
+
+
+
+#ifndef FADE_H_
+#define FADE_H_
+
+
+
+/**
+ * @brief	The most CnV values streamed to each LED channel in one fade
+ * @detail
+ * 		Each step is a 32-bit CnV write, so the buffers take
+ * 		3 * 4 * FADE_MAX_STEPS bytes of RAM
+ */
+#define FADE_MAX_STEPS\
+	(128)
+
+
+
+/**
+ * @brief	The shortest time in ms between fade steps. Steps any closer than
+ * 			one 500 Hz PWM period would be overwritten before they are seen
+ */
+#define FADE_MIN_STEP_MS\
+	(2)
+
+
+
+/**
+ * @brief	The longest fade in ms. TPM1 can stretch each of the
+ * 			FADE_MAX_STEPS steps to at most 2^7 * 2^16 TPM clock cycles
+ */
+#define FADE_MAX_DURATION_MS\
+	(20000)
+
+
+
+/**
+ * @brief	Fixed-point scale of fade progress, where FADE_ONE_Q15 is the end
+ */
+#define FADE_ONE_Q15\
+	(32768)
+
+
+
+/**
+ * @brief	Used to select how a fade moves from start level to end level
+ * @detail
+ * 		fade_linear:		Constant rate
+ * 		fade_ease_in:		Starts slow, ends fast (t^2)
+ * 		fade_ease_out:		Starts fast, ends slow (1 - (1 - t)^2)
+ * 		fade_ease_in_out:	Slow at both ends (smoothstep)
+ */
+typedef enum fade_curve_e{
+	fade_linear,
+	fade_ease_in,
+	fade_ease_out,
+	fade_ease_in_out
+} fade_curve_t;
+
+
+
+/**
+ * @brief	Defined in fade.c
+ */
+extern volatile bool fade_active;
+
+
+
+/**
+ * @brief	Ease fade progress according to the fade curve
+ * @param	t - Linear progress between 0 and FADE_ONE_Q15
+ * @param	fade_curve - The fade curve
+ * @return	Eased progress between 0 and FADE_ONE_Q15
+ * @detail
+ * 		Shifts and multiplies only, so it is cheap enough to call from an
+ * 		interrupt
+ */
+int32_t fade_ease(int32_t t, fade_curve_t fade_curve);
+
+
+
+/**
+ * @brief	Fade LED color(s) from one RGB level to another without CPU work
+ * 			during the fade
+ * @param	led_color - The LED color(s) to fade. Other colors hold their
+ * 			current level
+ * @param	start_level - The RGB level to start from
+ * @param	end_level - The RGB level to end on
+ * @param	duration_ms - How long the fade takes in ms
+ * @param	fade_curve - How the fade moves between the levels
+ * @return	EXIT_SUCCESS if the fade was started, EXIT_FAILURE if
+ * 			duration_ms is 0 or longer than FADE_MAX_DURATION_MS, or a scene
+ * 			is playing
+ * @detail
+ * 		The CnV value of every step is precomputed into RAM. TPM1 overflows
+ * 		once per step and each overflow requests DMA channel 0, which writes
+ * 		red and links to channel 1 (green), which links to channel 2 (blue).
+ * 		Writes land in buffered CnV registers, so steps only take effect at
+ * 		PWM period boundaries.
+ *
+ * 		While fade_active is set the TPM0 overflow interrupt keeps running
+ * 		but leaves CnV to DMA, and the render stage does not publish. When
+ * 		channel 2 finishes, DMA2_IRQHandler() publishes the end levels and
+ * 		clears fade_active. Starting a fade while one is running cancels the
+ * 		running fade
+ */
+int start_fade(led_color_t led_color, int16_t start_level, int16_t end_level, uint32_t duration_ms, fade_curve_t fade_curve);
+
+
+
+#endif /* FADE_H_ */
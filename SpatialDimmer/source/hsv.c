@@ -0,0 +1,240 @@
+/**
+ * @file	hsv.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for the fixed-point HSV color engine
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "led.h"		// Keep led.h included before mma8451q.h for led_color_t typedef
+#include "pipeline.h"	// Keep pipeline.h included before mma8451q.h for sample_block_t typedef
+#include "mma8451q.h"
+#include "hsv.h"
+#include "motion.h"
+#include "tpm.h"
+
+
+
+/**
+ * @brief	Divide a value between 0 and 255 * 255 by 255, exactly, with
+ * 			shifts and adds
+ */
+#define HSV_DIV255(x)\
+	(((x) + 1 + ((x) >> 8)) >> 8)
+
+
+
+/**
+ * @brief	x for 2^x, where 2^x is HSV_FULL_TILT. Resolved at build time so
+ * 			scaling tilt to saturation is a shift
+ */
+#define HSV_TILT_SHIFT\
+	(__builtin_ctz(HSV_FULL_TILT))
+
+
+
+/**
+ * @brief	The amount of CORDIC iterations. Each adds about one bit of angle
+ */
+#define HSV_CORDIC_ITERATIONS\
+	(12)
+
+
+
+/**
+ * @brief	Vector components are scaled up by 2^HSV_CORDIC_SHIFT so the later
+ * 			iterations, which shift by up to 11, still have bits to work with
+ */
+#define HSV_CORDIC_SHIFT\
+	(8)
+
+
+
+/**
+ * @brief	atan(2^-i) for each CORDIC iteration, in hue steps scaled up by 16
+ */
+static const int16_t hsv_cordic_angles[HSV_CORDIC_ITERATIONS] = {
+	3072, 1814, 958, 486, 244, 122, 61, 31, 15, 8, 4, 2
+};
+
+
+
+void hsv_to_rgb(uint16_t hue, uint8_t saturation, uint8_t value, int16_t *red_level, int16_t *green_level, int16_t *blue_level){
+
+	/**
+	 * Used to hold the sector of the color wheel, the position within it,
+	 * and the falling (q), rising (t) and minimum (p) components
+	 */
+	uint32_t sector = hue / HSV_SECTOR_STEPS;
+	uint32_t position = hue % HSV_SECTOR_STEPS;
+	int16_t p, q, t;
+
+	p = HSV_DIV255(value * (255U - saturation));
+	q = HSV_DIV255(value * (255U - HSV_DIV255(saturation * position)));
+	t = HSV_DIV255(value * (255U - HSV_DIV255(saturation * (255U - position))));
+
+
+
+	/**
+	 * Each sector holds one component at value and ramps another
+	 */
+	switch(sector){
+	case 0:
+		*red_level = value;
+		*green_level = t;
+		*blue_level = p;
+		break;
+	case 1:
+		*red_level = q;
+		*green_level = value;
+		*blue_level = p;
+		break;
+	case 2:
+		*red_level = p;
+		*green_level = value;
+		*blue_level = t;
+		break;
+	case 3:
+		*red_level = p;
+		*green_level = q;
+		*blue_level = value;
+		break;
+	case 4:
+		*red_level = t;
+		*green_level = p;
+		*blue_level = value;
+		break;
+	default:
+		*red_level = value;
+		*green_level = p;
+		*blue_level = q;
+		break;
+	}
+}
+
+
+
+uint16_t integer_atan2(int32_t y, int32_t x){
+
+	/**
+	 * Used to hold the angle rotated through so far, in hue steps scaled up
+	 * by 16, and the next x while rotating
+	 */
+	int32_t angle = 0;
+	int32_t next_x;
+
+
+
+	/**
+	 * CORDIC only converges within 90 degrees of the x axis, so turn vectors
+	 * in the left half-plane around first
+	 */
+	if((x == 0) && (y == 0)){
+		return 0;
+	}
+	if(x < 0){
+		x = -x;
+		y = -y;
+		angle = (HSV_HUE_STEPS / 2) * 16;
+	}
+	x <<= HSV_CORDIC_SHIFT;
+	y <<= HSV_CORDIC_SHIFT;
+
+
+
+	/**
+	 * Rotate the vector onto the x axis, adding up the angles rotated by
+	 */
+	for(int i = 0; i < HSV_CORDIC_ITERATIONS; i++){
+		if(y > 0){
+			next_x = x + (y >> i);
+			y -= (x >> i);
+			angle += hsv_cordic_angles[i];
+		}
+		else{
+			next_x = x - (y >> i);
+			y += (x >> i);
+			angle -= hsv_cordic_angles[i];
+		}
+		x = next_x;
+	}
+
+
+
+	/**
+	 * Round back to hue steps and wrap into a single turn
+	 */
+	angle = (angle + 8) >> 4;
+	if(angle < 0){
+		angle += HSV_HUE_STEPS;
+	}
+	else if(angle >= HSV_HUE_STEPS){
+		angle -= HSV_HUE_STEPS;
+	}
+
+	return ((uint16_t)angle);
+}
+
+
+
+/**
+ * @brief	Map one sample's tilt to RGB levels through HSV
+ * @param	x - The sample's x value
+ * @param	y - The sample's y value
+ * @param	red_level - Where to store the red level
+ * @param	green_level - Where to store the green level
+ * @param	blue_level - Where to store the blue level
+ */
+static inline void hsv_from_tilt(int16_t x, int16_t y, int16_t *red_level, int16_t *green_level, int16_t *blue_level){
+
+	/**
+	 * Used to hold how far the fixture is tilted, and the resulting
+	 * saturation and value
+	 */
+	uint32_t tilt;
+	uint32_t saturation;
+	uint32_t value;
+
+
+
+	/**
+	 * The horizontal components of gravity give both the direction and the
+	 * amount of tilt
+	 */
+	tilt = integer_sqrt((uint32_t)((int32_t)x * x) + (uint32_t)((int32_t)y * y));
+	saturation = (tilt * 255U) >> HSV_TILT_SHIFT;
+	if(saturation > 255U){
+		saturation = 255U;
+	}
+	value = HSV_FLAT_VALUE + HSV_DIV255((255U - HSV_FLAT_VALUE) * saturation);
+
+	hsv_to_rgb(integer_atan2(y, x), (uint8_t)saturation, (uint8_t)value, red_level, green_level, blue_level);
+}
+
+
+
+void calculate_rgb_from_hsv(void){
+
+	hsv_from_tilt(current_x, current_y, &current_red_level, &current_green_level, &current_blue_level);
+}
+
+
+
+void calculate_rgb_block_from_hsv(const sample_block_t *sample_block, rgb_block_t *rgb_block){
+
+	for(int i = 0; i < sample_block->count; i++){
+		hsv_from_tilt(sample_block->x[i], sample_block->y[i], &rgb_block->red[i], &rgb_block->green[i], &rgb_block->blue[i]);
+	}
+	rgb_block->count = sample_block->count;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file	hsv.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros and function headers for the fixed-point HSV color engine
+ */
+
+
+
+#ifndef HSV_H_
+#define HSV_H_
+
+
+
+/**
+ * @brief	The amount of hue steps in each of the six sectors of the color
+ * 			wheel (red-yellow, yellow-green, green-cyan, cyan-blue,
+ * 			blue-magenta and magenta-red)
+ */
+#define HSV_SECTOR_STEPS\
+	(256)
+
+
+
+/**
+ * @brief	The amount of hue steps in a full turn of the color wheel. Hue 0
+ * 			is red
+ */
+#define HSV_HUE_STEPS\
+	(6 * HSV_SECTOR_STEPS)
+
+
+
+/**
+ * @brief	Tilt, in XYZ counts, at which orientation reaches full saturation.
+ * 			At 14-bit resolution 1g is 4096 counts, so 2048 is a 30 degree tilt
+ */
+#define HSV_FULL_TILT\
+	(2048)
+
+
+
+/**
+ * @brief	The value (brightness) of the fixture while lying flat, between 0
+ * 			and 255. Value rises to 255 with tilt alongside saturation
+ */
+#define HSV_FLAT_VALUE\
+	(64)
+
+
+
+/**
+ * @brief	Convert a color from HSV to RGB levels
+ * @param	hue - The hue, between 0 and HSV_HUE_STEPS - 1
+ * @param	saturation - The saturation, between 0 (white) and 255
+ * @param	value - The value (brightness), between 0 and 255
+ * @param	red_level - Where to store the red level
+ * @param	green_level - Where to store the green level
+ * @param	blue_level - Where to store the blue level
+ * @detail
+ * 		Integer-only: hue is split into sector and position with a shift and
+ * 		mask, and divisions by 255 are done as multiply-and-shift, so the
+ * 		conversion has no divides. Usable by any code that needs a color
+ * 		from HSV
+ */
+void hsv_to_rgb(uint16_t hue, uint8_t saturation, uint8_t value, int16_t *red_level, int16_t *green_level, int16_t *blue_level);
+
+
+
+/**
+ * @brief	Calculate the angle of a vector as a hue
+ * @param	y - The y component of the vector
+ * @param	x - The x component of the vector
+ * @return	The angle from the positive x axis towards the positive y axis,
+ * 			between 0 and HSV_HUE_STEPS - 1
+ * @detail
+ * 		Uses CORDIC vectoring, which only needs shifts, adds and a small
+ * 		table of arctangents
+ */
+uint16_t integer_atan2(int32_t y, int32_t x);
+
+
+
+/**
+ * @brief	Map the current tilt to RGB levels through HSV
+ * @detail
+ * 		Hue follows the direction the fixture is tilted towards (the azimuth
+ * 		of current_x and current_y), and saturation and value grow with how
+ * 		far it is tilted
+ */
+void calculate_rgb_from_hsv(void);
+
+
+
+/**
+ * @brief	Map a block of XYZ samples to RGB levels through HSV
+ * @param	sample_block - The block to map from
+ * @param	rgb_block - The block to map to
+ */
+void calculate_rgb_block_from_hsv(const sample_block_t *sample_block, rgb_block_t *rgb_block);
+
+
+
+#endif /* HSV_H_ */
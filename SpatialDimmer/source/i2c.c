@@ -18,6 +18,7 @@
 /**
  * User-defined libraries
  */
+#include "delay.h"
 #include "i2c.h"
 
 
@@ -241,17 +242,11 @@
 
 
 /**
- * @brief	The amount of locks to detect on I2C0 bus before declaring line busy
+ * @brief	How long in us to wait for a transfer on I2C0 before declaring the
+ * 			line busy. A byte and its acknowledge take about 21 us at 428 kHz
  */
-#define I2C_LOCK_DETECT_MAX\
-	(200)
-
-
-
-/**
- * @brief	Used to track number of I2C locks in i2c0_wait()
- */
-int lock_detect = 0;
+#define I2C_WAIT_TIMEOUT_US\
+	(100)
 
 
 
@@ -452,13 +447,6 @@ uint8_t i2c0_repeated_read_byte(bool is_final_byte){
 
 
 
-	/**
-	 * Reset lock detect count
-	 */
-	lock_detect = 0;
-
-
-
 	/**
 	 * If this is the final byte to be read, set NACK after read
 	 * Else, set ACK after read
@@ -522,19 +510,24 @@ void i2c0_stop(void){
 void i2c0_wait(void){
 
 	/**
-	 * Reset and calculate number of locks
+	 * Used to bound the wait for the transfer
 	 */
-	lock_detect = 0;
-	while(((I2C0->S & I2C_S_IICIF_MASK) == 0) && (lock_detect < I2C_LOCK_DETECT_MAX)) {
-		lock_detect++;
-	}
+	deadline_t deadline;
 
 
 
 	/**
-	 * If enough locks detected, declare I2C0 line busy
+	 * Wait for the transfer to complete
 	 */
-	if(lock_detect >= I2C_LOCK_DETECT_MAX){
+	start_deadline(&deadline, I2C_WAIT_TIMEOUT_US);
+	while(((I2C0->S & I2C_S_IICIF_MASK) == 0) && !deadline_expired(&deadline));
+
+
+
+	/**
+	 * If it never completed, declare I2C0 line busy
+	 */
+	if((I2C0->S & I2C_S_IICIF_MASK) == 0){
 		i2c0_busy();
 	}
 
@@ -551,9 +544,9 @@ void i2c0_wait(void){
 void i2c0_busy(void){
 
 	/**
-	 * Reset lock_detect and start I2C0
+	 * Used to bound the wait for the line to clear
 	 */
-	lock_detect = 0;
+	deadline_t deadline;
 
 
 
@@ -584,9 +577,12 @@ void i2c0_busy(void){
 
 
 	/**
-	 * Wait for interrupt and then clear the interrupt bit by writing to it
+	 * Wait for interrupt and then clear the interrupt bit by writing to it.
+	 * A bus held low may never complete the byte, so the wait is bounded and
+	 * recovery carries on either way
 	 */
-	while ((I2C0->S & I2C_S_IICIF_MASK) == 0U);
+	start_deadline(&deadline, I2C_WAIT_TIMEOUT_US);
+	while(((I2C0->S & I2C_S_IICIF_MASK) == 0U) && !deadline_expired(&deadline));
 
 
 
@@ -623,11 +619,4 @@ void i2c0_busy(void){
 	 */
 	I2C0->S |= I2C_S_IICIF_MASK;
 	I2C0->S |= I2C_S_ARBL_MASK;
-
-
-
-	/**
-	 * Reset lock_detect now that I2C0 is no longer busy
-	 */
-	lock_detect = 0;
 }
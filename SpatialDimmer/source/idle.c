@@ -0,0 +1,342 @@
+/**
+ * @file	idle.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for low-power idle
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include "board.h"
+#include "fsl_flash.h"
+#include "fsl_smc.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "idle.h"
+#include "led.h"		// Keep led.h included before fade.h and tpm.h for led_color_t typedef
+#include "fade.h"
+#include "lptmr.h"
+#include "sampling.h"
+#include "scene.h"
+#include "timebase.h"
+#include "tpm.h"
+#include "watchdog.h"
+#include "ws2812.h"
+
+
+
+/**
+ * @brief	MCG S[CLKST] value while the PLL clocks the MCU
+ */
+#define MCG_CLKST_PLL\
+	(3)
+
+
+
+/**
+ * @brief	How many times to poll for each MCG step while relocking before
+ * 			giving up. The core runs from the 8 MHz crystal meanwhile and each
+ * 			poll takes at least 4 cycles, so this waits at least 2 ms, several
+ * 			lock times
+ */
+#define IDLE_RELOCK_POLLS\
+	(4000)
+
+
+
+/**
+ * @brief	How many times to try relocking the PLL after VLPS before
+ * 			resetting the MCU
+ */
+#define IDLE_RELOCK_ATTEMPTS\
+	(2)
+
+
+
+/**
+ * @brief	Whether VLPS is allowed
+ */
+static bool idle_vlps_ready = false;
+
+
+
+/**
+ * @brief	The residency since reset_idle_residency(), and when that was
+ */
+static uint32_t idle_entries[idle_mode_count];
+static uint64_t idle_us[idle_mode_count];
+static uint64_t idle_window_start = 0;
+
+
+
+int init_idle(void){
+
+	/**
+	 * Allow VLPS, in the only write PMPROT takes
+	 */
+	SMC_SetPowerModeProtection(SMC, kSMC_AllowPowerModeVlp);
+	reset_idle_residency();
+	idle_vlps_ready = true;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+/**
+ * @brief	Check nothing needs the clocks VLPS stops
+ * @return	true if VLPS is safe, otherwise false
+ * @detail
+ * 		The TPMs stop with their outputs frozen, which only goes unnoticed
+ * 		while every level is 0. VLPS also needs the LPTMR free to time it,
+ * 		which idle_enter_vlps() finds out when it starts the timeout
+ */
+static bool idle_vlps_safe(void){
+
+	return (idle_vlps_ready &&
+		!fade_active &&
+		!scene_active &&
+		!ws2812_busy &&
+		(current_red_level == 0) &&
+		(current_green_level == 0) &&
+		(current_blue_level == 0) &&
+		(UART0->S1 & UART0_S1_TC_MASK));
+}
+
+
+
+/**
+ * @brief	Poll MCG S for a status field, giving up after IDLE_RELOCK_POLLS
+ * @param	mask - The status field to poll
+ * @param	value - The value to wait for, in place within the field
+ * @return	true if the field reached the value in time, otherwise false
+ */
+static bool idle_poll_mcg(uint8_t mask, uint8_t value){
+
+	for(uint32_t polls = 0; polls < IDLE_RELOCK_POLLS; polls++){
+		if((MCG->S & mask) == value){
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+
+/**
+ * @brief	Wait for the PLL to lock again after VLPS, and switch back to it
+ * @return	true if the PLL clocks the MCU again, or false if it did not lock
+ * 			in IDLE_RELOCK_ATTEMPTS and the MCU is still in PBE
+ * @detail
+ * 		Stop modes turn the PLL off, and leaving them from PEE returns to PBE
+ * 		with the core running from the crystal. Interrupts are masked, so
+ * 		each wait is bounded by polls rather than time. Each retry restarts
+ * 		the PLL by dropping to FBE and back, which the core clock, still on
+ * 		the crystal, does not notice
+ */
+static bool idle_relock_pll(void){
+
+	for(uint8_t attempt = 0; attempt < IDLE_RELOCK_ATTEMPTS; attempt++){
+		if(attempt > 0){
+			MCG->C6 &= ~MCG_C6_PLLS_MASK;
+			if(!idle_poll_mcg(MCG_S_PLLST_MASK, 0)){
+				continue;
+			}
+			MCG->C6 |= MCG_C6_PLLS_MASK;
+			if(!idle_poll_mcg(MCG_S_PLLST_MASK, MCG_S_PLLST_MASK)){
+				continue;
+			}
+		}
+		if(idle_poll_mcg(MCG_S_LOCK0_MASK, MCG_S_LOCK0_MASK)){
+			MCG->C1 &= ~MCG_C1_CLKS_MASK;
+			return idle_poll_mcg(MCG_S_CLKST_MASK, MCG_S_CLKST(MCG_CLKST_PLL));
+		}
+	}
+
+	return false;
+}
+
+
+
+/**
+ * @brief	Enter VLPS until the LPTMR or another interrupt wakes the MCU
+ * @param	sleep_us - The longest to stay in VLPS
+ * @return	Microseconds from entering VLPS to the PLL clocking the MCU again,
+ * 			or 0 if the LPTMR is in use and VLPS was not entered
+ */
+static uint32_t idle_enter_vlps(uint32_t sleep_us){
+
+	/**
+	 * Used to hold the clock mode before VLPS, when the timebase stopped and
+	 * how long it stopped for
+	 */
+	uint8_t clkst;
+	uint32_t pit_start;
+	uint32_t pit_us;
+	uint32_t slept_us;
+	flash_prefetch_speculation_status_t speculation;
+
+
+
+	/**
+	 * Borrow the LPTMR to wake the MCU when the sleep is up. Timed sampling
+	 * may own it, in which case VLPS cannot be timed
+	 */
+	if(sleep_us > LPTMR_TIMEOUT_MAX_US){
+		sleep_us = LPTMR_TIMEOUT_MAX_US;
+	}
+	if(start_lptmr_timeout(sleep_us) != EXIT_SUCCESS){
+		return 0;
+	}
+
+
+
+	/**
+	 * UART0 stops with its clock, so wake on an edge on its receive pin
+	 * (RXEDGIF is write 1 to clear)
+	 */
+	UART0->S2 |= UART0_S2_RXEDGIF_MASK;
+	UART0->BDH |= UART0_BDH_RXEDGIE_MASK;
+
+
+
+	/**
+	 * Enter VLPS with flash speculation off, as a stop can interrupt a
+	 * speculative fetch. Should the PLL not lock again, every clock derived
+	 * from it is wrong, so note why and reset the MCU to set them up afresh
+	 */
+	clkst = (MCG->S & MCG_S_CLKST_MASK) >> MCG_S_CLKST_SHIFT;
+	pit_start = get_timebase_us32();
+	speculation.instructionOption = kFLASH_prefetchSpeculationOptionDisable;
+	speculation.dataOption = kFLASH_prefetchSpeculationOptionDisable;
+	FLASH_PflashSetPrefetchSpeculation(&speculation);
+	SMC_SetPowerModeVlps(SMC);
+	speculation.instructionOption = kFLASH_prefetchSpeculationOptionEnable;
+	speculation.dataOption = kFLASH_prefetchSpeculationOptionEnable;
+	FLASH_PflashSetPrefetchSpeculation(&speculation);
+	if((clkst == MCG_CLKST_PLL) && (((MCG->S & MCG_S_CLKST_MASK) >> MCG_S_CLKST_SHIFT) != MCG_CLKST_PLL)){
+		if(!idle_relock_pll()){
+			record_watchdog_pll_unlocked();
+			NVIC_SystemReset();
+		}
+	}
+	UART0->BDH &= ~UART0_BDH_RXEDGIE_MASK;
+	UART0->S2 |= UART0_S2_RXEDGIF_MASK;
+
+
+
+	/**
+	 * Read how long the MCU was asleep or relocking, and hand the LPTMR back
+	 */
+	slept_us = stop_lptmr_timeout();
+
+
+
+	/**
+	 * Give the timebase the time the PIT missed. It ran, slowly, while the
+	 * PLL relocked, so only the difference is added
+	 */
+	pit_us = get_timebase_us32() - pit_start;
+	if(slept_us > pit_us){
+		advance_timebase(slept_us - pit_us);
+	}
+
+	return slept_us;
+}
+
+
+
+uint32_t enter_idle(uint32_t budget_us){
+
+	/**
+	 * Used to time WAIT, and hold the time spent in VLPS
+	 */
+	uint32_t start;
+	uint32_t slept_us;
+
+
+
+	/**
+	 * A pending interrupt would wake the MCU at once, and abort VLPS
+	 */
+	if(SCB->ICSR & (SCB_ICSR_ISRPENDING_Msk | SCB_ICSR_PENDSVSET_Msk | SCB_ICSR_PENDSTSET_Msk)){
+		return 0;
+	}
+
+
+
+	/**
+	 * The next sample comes at most a sample period from now, long enough
+	 * for VLPS only while sampling rests. Enter VLPS only if it is worth it
+	 * and safe, leaving it in time to wake up
+	 */
+	if(sampling_active && (budget_us > get_sampling_period_us())){
+		budget_us = get_sampling_period_us();
+	}
+	if((budget_us >= IDLE_VLPS_MIN_US) && idle_vlps_safe()){
+		slept_us = idle_enter_vlps(budget_us - IDLE_VLPS_WAKE_US);
+		if(slept_us > 0){
+			idle_entries[idle_vlps]++;
+			idle_us[idle_vlps] += slept_us;
+			return slept_us;
+		}
+	}
+
+
+
+	/**
+	 * Otherwise WAIT, where SysTick keeps counting
+	 */
+	start = get_timebase_us32();
+	SMC_SetPowerModeWait(SMC);
+	idle_entries[idle_wait]++;
+	idle_us[idle_wait] += get_timebase_us32() - start;
+
+	return 0;
+}
+
+
+
+void get_idle_residency(idle_residency_t *residency){
+
+	/**
+	 * Used to copy the residency out without idle updating it in between
+	 */
+	uint32_t irq_mask;
+
+	irq_mask = DisableGlobalIRQ();
+	for(uint8_t i = 0; i < idle_mode_count; i++){
+		residency->entries[i] = idle_entries[i];
+		residency->us[i] = idle_us[i];
+	}
+	residency->window_us = get_timebase_us() - idle_window_start;
+	EnableGlobalIRQ(irq_mask);
+}
+
+
+
+void reset_idle_residency(void){
+
+	/**
+	 * Used to clear the residency without idle updating it in between
+	 */
+	uint32_t irq_mask;
+
+	irq_mask = DisableGlobalIRQ();
+	for(uint8_t i = 0; i < idle_mode_count; i++){
+		idle_entries[i] = 0;
+		idle_us[i] = 0;
+	}
+	idle_window_start = get_timebase_us();
+	EnableGlobalIRQ(irq_mask);
+}
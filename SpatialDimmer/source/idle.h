@@ -0,0 +1,112 @@
+/**
+ * @file	idle.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros, types and function headers for low-power idle
+ */
+
+
+
+#ifndef IDLE_H_
+#define IDLE_H_
+
+
+
+/**
+ * @brief	The longest it takes to run again after VLPS, in us: the PLL
+ * 			relocking, with margin. VLPS is left this long before the next
+ * 			scheduled event
+ */
+#define IDLE_VLPS_WAKE_US\
+	(500)
+
+
+
+/**
+ * @brief	The shortest idle worth entering VLPS for, in us. Shorter idles
+ * 			use WAIT, since the wake-up would cost more than it saves
+ */
+#define IDLE_VLPS_MIN_US\
+	(4 * IDLE_VLPS_WAKE_US)
+
+
+
+/**
+ * @brief	The low-power modes idle can enter
+ * @detail
+ * 		idle_wait:	WAIT. Only the core clock stops, every peripheral runs
+ * 					and any interrupt wakes at once
+ * 		idle_vlps:	VLPS. Every clock but OSCERCLK and the LPO stops, and
+ * 					the LPTMR wakes before the next scheduled event
+ */
+typedef enum idle_mode_e{
+	idle_wait,
+	idle_vlps,
+	idle_mode_count
+} idle_mode_t;
+
+
+
+/**
+ * @brief	Time spent in each low-power mode
+ * @detail
+ * 		entries:	How many times each mode was entered
+ * 		us:			Microseconds spent in each mode
+ * 		window_us:	Microseconds since the residency was last reset, the
+ * 					rest of which was spent running
+ */
+typedef struct idle_residency_s{
+	uint32_t entries[idle_mode_count];
+	uint64_t us[idle_mode_count];
+	uint64_t window_us;
+} idle_residency_t;
+
+
+
+/**
+ * @brief	Allow VLPS
+ * @return	EXIT_SUCCESS
+ * @detail
+ * 		PMPROT can only be written once after reset, so this is its only
+ * 		write. VLPS is timed with an LPTMR timeout (see lptmr.h), so idle
+ * 		only uses WAIT while the LPTMR is in use or cannot time one
+ */
+int init_idle(void);
+
+
+
+/**
+ * @brief	Enter the deepest low-power mode that is safe until an interrupt
+ * @param	budget_us - Microseconds until the next scheduled event
+ * @return	Microseconds spent in VLPS, during which SysTick was stopped, or
+ * 			0 after WAIT
+ * @detail
+ * 		Call with interrupts masked; returns with them still masked. VLPS is
+ * 		only used when the budget allows it and nothing needs the clocks it
+ * 		stops: no PWM output, fade, scene, DMA transfer, UART transmission,
+ * 		timed sampling or sample due within the budget, so it is reached
+ * 		while sampling rests (see sampling.h). The timebase is advanced by
+ * 		the time spent in VLPS. A byte received in VLPS wakes the MCU but is
+ * 		lost. Should the PLL not lock again after VLPS, the MCU is reset
+ * 		and the watchdog record says why (see watchdog.h)
+ */
+uint32_t enter_idle(uint32_t budget_us);
+
+
+
+/**
+ * @brief	Read the time spent in each low-power mode
+ * @param	residency - Where to copy the residency out to
+ */
+void get_idle_residency(idle_residency_t *residency);
+
+
+
+/**
+ * @brief	Start the residency over from now
+ */
+void reset_idle_residency(void);
+
+
+
+#endif /* IDLE_H_ */
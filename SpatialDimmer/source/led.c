@@ -105,74 +105,24 @@
 
 
 /**
- * @brief	Turn off on-board red LED through digital GPIO port
+ * @brief	The port B and port D pins of each LED color, indexed by
+ * 			led_color_t
  */
-#define DIGITAL_CLEAR_RED_LED()\
-	(PTB->PSOR |= MASK(1UL, PORTB_RED_LED_PIN))
+static const uint32_t portb_led_masks[white + 1] = {
+	[red] = MASK(1UL, PORTB_RED_LED_PIN),
+	[green] = MASK(1UL, PORTB_GREEN_LED_PIN),
+	[yellow] = MASK(1UL, PORTB_RED_LED_PIN) | MASK(1UL, PORTB_GREEN_LED_PIN),
+	[magenta] = MASK(1UL, PORTB_RED_LED_PIN),
+	[cyan] = MASK(1UL, PORTB_GREEN_LED_PIN),
+	[white] = MASK(1UL, PORTB_RED_LED_PIN) | MASK(1UL, PORTB_GREEN_LED_PIN)
+};
 
-
-
-/**
- * @brief	Turn off on-board green LED through digital GPIO port
- */
-#define DIGITAL_CLEAR_GREEN_LED()\
-	(PTB->PSOR |= MASK(1UL, PORTB_GREEN_LED_PIN))
-
-
-
-/**
- * @brief	Turn off on-board blue LED through digital GPIO port
- */
-#define DIGITAL_CLEAR_BLUE_LED()\
-	(PTD->PSOR |= MASK(1UL, PORTD_BLUE_LED_PIN))
-
-
-
-/**
- * @brief	Turn on on-board red LED through digital GPIO port
- */
-#define DIGITAL_SET_RED_LED()\
-	(PTB->PCOR |= MASK(1UL, PORTB_RED_LED_PIN))
-
-
-
-/**
- * @brief	Turn on on-board green LED through digital GPIO port
- */
-#define DIGITAL_SET_GREEN_LED()\
-	(PTB->PCOR |= MASK(1UL, PORTB_GREEN_LED_PIN))
-
-
-
-/**
- * @brief	Turn on on-board blue LED through digital GPIO port
- */
-#define DIGITAL_SET_BLUE_LED()\
-	(PTD->PCOR |= MASK(1UL, PORTD_BLUE_LED_PIN))
-
-
-
-/**
- * @brief	Toggle on-board red LED through digital GPIO port
- */
-#define DIGITAL_TOGGLE_RED_LED()\
-	(PTB->PTOR |= MASK(1UL, PORTB_RED_LED_PIN))
-
-
-
-/**
- * @brief	Toggle on-board green LED through digital GPIO port
- */
-#define DIGITAL_TOGGLE_GREEN_LED()\
-	(PTB->PTOR |= MASK(1UL, PORTB_GREEN_LED_PIN))
-
-
-
-/**
- * @brief	Toggle on-board blue LED through digital GPIO port
- */
-#define DIGITAL_TOGGLE_BLUE_LED()\
-	(PTD->PTOR |= MASK(1UL, PORTD_BLUE_LED_PIN))
+static const uint32_t portd_led_masks[white + 1] = {
+	[blue] = MASK(1UL, PORTD_BLUE_LED_PIN),
+	[magenta] = MASK(1UL, PORTD_BLUE_LED_PIN),
+	[cyan] = MASK(1UL, PORTD_BLUE_LED_PIN),
+	[white] = MASK(1UL, PORTD_BLUE_LED_PIN)
+};
 
 
 
@@ -310,127 +260,50 @@ void init_blue_onboard_led(led_type_t led_type){
 void digital_control_onboard_leds(led_color_t led_color, led_action_t led_action){
 
 	/**
-	 * Control LEDs based on specified LED(s), then action
+	 * Used to hold the pins of the given LED(s) on each port
 	 */
-	switch(led_color){
-	case red:
-		switch(led_action){
-		case digital_clear:
-			DIGITAL_CLEAR_RED_LED();
-			break;
-		case digital_set:
-			DIGITAL_SET_RED_LED();
-			break;
-		case digital_toggle:
-			DIGITAL_TOGGLE_RED_LED();
-			break;
-		default:
-			break;
-		}
-		break;
-	case green:
-		switch(led_action){
-		case digital_clear:
-			DIGITAL_CLEAR_GREEN_LED();
-			break;
-		case digital_set:
-			DIGITAL_SET_GREEN_LED();
-			break;
-		case digital_toggle:
-			DIGITAL_TOGGLE_GREEN_LED();
-			break;
-		default:
-			break;
+	uint32_t portb_mask;
+	uint32_t portd_mask;
+
+
+
+	/**
+	 * Look up the pins of every given LED at once
+	 */
+	led_color &= white;
+	portb_mask = portb_led_masks[led_color];
+	portd_mask = portd_led_masks[led_color];
+
+
+
+	/**
+	 * Write each port's set/clear/toggle register once. These registers are
+	 * write-only, so a plain store is enough. Note that on-board LEDs are
+	 * active-low
+	 */
+	switch(led_action){
+	case digital_clear:
+		if(portb_mask){
+			PTB->PSOR = portb_mask;
 		}
-		break;
-	case blue:
-		switch(led_action){
-		case digital_clear:
-			DIGITAL_CLEAR_BLUE_LED();
-			break;
-		case digital_set:
-			DIGITAL_SET_BLUE_LED();
-			break;
-		case digital_toggle:
-			DIGITAL_TOGGLE_BLUE_LED();
-			break;
-		default:
-			break;
+		if(portd_mask){
+			PTD->PSOR = portd_mask;
 		}
 		break;
-	case cyan:
-		switch(led_action){
-		case digital_clear:
-			DIGITAL_CLEAR_GREEN_LED();
-			DIGITAL_CLEAR_BLUE_LED();
-			break;
-		case digital_set:
-			DIGITAL_SET_GREEN_LED();
-			DIGITAL_SET_BLUE_LED();
-			break;
-		case digital_toggle:
-			DIGITAL_TOGGLE_GREEN_LED();
-			DIGITAL_TOGGLE_BLUE_LED();
-			break;
-		default:
-			break;
+	case digital_set:
+		if(portb_mask){
+			PTB->PCOR = portb_mask;
 		}
-		break;
-	case magenta:
-		switch(led_action){
-		case digital_clear:
-			DIGITAL_CLEAR_RED_LED();
-			DIGITAL_CLEAR_BLUE_LED();
-			break;
-		case digital_set:
-			DIGITAL_SET_RED_LED();
-			DIGITAL_SET_BLUE_LED();
-			break;
-		case digital_toggle:
-			DIGITAL_TOGGLE_RED_LED();
-			DIGITAL_TOGGLE_BLUE_LED();
-			break;
-		default:
-			break;
+		if(portd_mask){
+			PTD->PCOR = portd_mask;
 		}
 		break;
-	case yellow:
-		switch(led_action){
-		case digital_clear:
-			DIGITAL_CLEAR_RED_LED();
-			DIGITAL_CLEAR_GREEN_LED();
-			break;
-		case digital_set:
-			DIGITAL_SET_RED_LED();
-			DIGITAL_SET_GREEN_LED();
-			break;
-		case digital_toggle:
-			DIGITAL_TOGGLE_RED_LED();
-			DIGITAL_TOGGLE_GREEN_LED();
-			break;
-		default:
-			break;
+	case digital_toggle:
+		if(portb_mask){
+			PTB->PTOR = portb_mask;
 		}
-		break;
-	case white:
-		switch(led_action){
-		case digital_clear:
-			DIGITAL_CLEAR_RED_LED();
-			DIGITAL_CLEAR_GREEN_LED();
-			DIGITAL_CLEAR_BLUE_LED();
-			break;
-		case digital_set:
-			DIGITAL_SET_RED_LED();
-			DIGITAL_SET_GREEN_LED();
-			DIGITAL_SET_BLUE_LED();
-			break;
-		case digital_toggle:
-			DIGITAL_TOGGLE_RED_LED();
-			DIGITAL_TOGGLE_GREEN_LED();
-			DIGITAL_TOGGLE_BLUE_LED();
-			break;
-		default:
-			break;
+		if(portd_mask){
+			PTD->PTOR = portd_mask;
 		}
 		break;
 	default:
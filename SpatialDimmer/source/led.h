@@ -14,19 +14,31 @@
 
 /**
  * @brief	Used to refer to aspect of on-board RGB LED
+ * @detail
+ * 		Each color is a bitmask of red, green and blue, so colors can also be
+ * 		combined with | (e.g. red | blue is magenta)
  */
 typedef enum led_color_e{
-	red,
-	green,
-	blue,
-	cyan,
-	magenta,
-	yellow,
-	white
+	red = 0x1,
+	green = 0x2,
+	blue = 0x4,
+	cyan = (green | blue),
+	magenta = (red | blue),
+	yellow = (red | green),
+	white = (red | green | blue)
 } led_color_t;
 
 
 
+/**
+ * @brief	Index of a single LED color (red, green or blue) in per-channel
+ * 			arrays, in that order
+ */
+#define LED_CHANNEL_INDEX(led_color)\
+	((led_color) >> 1)
+
+
+
 /**
  * @brief	Used to refer to set on-board RGB LED output type
  */
@@ -133,6 +145,9 @@ void init_blue_onboard_led(led_type_t led_type);
  * @param	led_color - The LED color(s) to perform the action on
  * @param	led_action - The action to perform on LED color(s)
  * @detail
+ * 		The pins of each port are gathered into one mask, so each port takes
+ * 		at most one store however many colors are given
+ *
  * 		Many operations were referenced from Alexander G Dean (Chapter 2 of
  * 		Embedded Systems Fundamentals with ARM Cortex-M Based Microcontrollers)
  *
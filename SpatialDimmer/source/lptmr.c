@@ -0,0 +1,213 @@
+/**
+ * @file	lptmr.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for sharing the low-power timer
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include "board.h"
+#include "fsl_clock.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "deferred.h"
+#include "lptmr.h"
+
+
+
+/**
+ * @brief	The largest LPTMR PSR[PRESCALE] value, dividing by 65536
+ */
+#define LPTMR_PRESCALE_MAX\
+	(15)
+
+
+
+/**
+ * @brief	Whether timeouts can be timed, and the prescaler giving
+ * 			LPTMR_TIMEOUT_HZ from OSCERCLK
+ */
+static bool lptmr_timeout_ready = false;
+static uint8_t lptmr_timeout_prescale = 0;
+
+
+
+/**
+ * @brief	Whether the LPTMR is running, the handler of a fixed rate and the
+ * 			length of a timeout
+ */
+static bool lptmr_in_use = false;
+static void (*lptmr_handler)(void) = NULL;
+static uint32_t lptmr_timeout_us = 0;
+
+
+
+int init_lptmr(void){
+
+	/**
+	 * Used to hold the LPTMR clock and how far it must be divided
+	 */
+	uint32_t oscerclk_hz = CLOCK_GetOsc0ErClkFreq();
+	uint32_t divider;
+
+
+
+	/**
+	 * Keep OSCERCLK running in stop modes so the LPTMR counts through them
+	 */
+	SIM->SCGC5 |= SIM_SCGC5_LPTMR_MASK;
+	OSC0->CR |= OSC_CR_EREFSTEN_MASK;
+	LPTMR0->CSR = 0;
+	NVIC_SetPriority(LPTMR0_IRQn, DEFERRED_URGENT_PRIORITY);
+
+
+
+	/**
+	 * The prescaler divides by 2^(PRESCALE + 1), so OSCERCLK must be a power
+	 * of two multiple of LPTMR_TIMEOUT_HZ
+	 */
+	if((oscerclk_hz == 0) || ((oscerclk_hz % LPTMR_TIMEOUT_HZ) != 0)){
+		return EXIT_FAILURE;
+	}
+	divider = oscerclk_hz / LPTMR_TIMEOUT_HZ;
+	for(lptmr_timeout_prescale = 0; lptmr_timeout_prescale <= LPTMR_PRESCALE_MAX; lptmr_timeout_prescale++){
+		if(divider == (2UL << lptmr_timeout_prescale)){
+			break;
+		}
+	}
+	if(lptmr_timeout_prescale > LPTMR_PRESCALE_MAX){
+		return EXIT_FAILURE;
+	}
+	lptmr_timeout_ready = true;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+int start_lptmr_periodic(uint32_t hz, void (*handler)(void)){
+
+	/**
+	 * Used to hold the LPTMR clock
+	 */
+	uint32_t oscerclk_hz = CLOCK_GetOsc0ErClkFreq();
+
+
+
+	/**
+	 * The compare value must give the period exactly and fit in 16 bits
+	 */
+	if(lptmr_in_use || (hz == 0) || (oscerclk_hz == 0) || ((oscerclk_hz % hz) != 0) || ((oscerclk_hz / hz) > (LPTMR_CMR_COMPARE_MASK + 1))){
+		return EXIT_FAILURE;
+	}
+	lptmr_in_use = true;
+	lptmr_handler = handler;
+
+
+
+	/**
+	 * Configure the LPTMR while disabled:
+	 * 	- Count OSCERCLK directly, bypassing the prescaler
+	 * 	- Time counter mode, resetting on each compare so every period is
+	 * 	  exactly CMR + 1 counts
+	 * 	- Interrupt on each compare
+	 */
+	LPTMR0->CSR = 0;
+	LPTMR0->PSR = LPTMR_PSR_PCS(LPTMR_PCS_OSCERCLK) | LPTMR_PSR_PBYP_MASK;
+	LPTMR0->CMR = (oscerclk_hz / hz) - 1;
+	NVIC_ClearPendingIRQ(LPTMR0_IRQn);
+	NVIC_EnableIRQ(LPTMR0_IRQn);
+	LPTMR0->CSR = LPTMR_CSR_TCF_MASK | LPTMR_CSR_TIE_MASK | LPTMR_CSR_TEN_MASK;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+void stop_lptmr_periodic(void){
+
+	LPTMR0->CSR = LPTMR_CSR_TCF_MASK;
+	NVIC_DisableIRQ(LPTMR0_IRQn);
+	NVIC_ClearPendingIRQ(LPTMR0_IRQn);
+	lptmr_handler = NULL;
+	lptmr_in_use = false;
+}
+
+
+
+int start_lptmr_timeout(uint32_t timeout_us){
+
+	if(lptmr_in_use || !lptmr_timeout_ready || (timeout_us == 0) || (timeout_us > LPTMR_TIMEOUT_MAX_US)){
+		return EXIT_FAILURE;
+	}
+	lptmr_in_use = true;
+	lptmr_timeout_us = timeout_us;
+
+
+
+	/**
+	 * Configure the LPTMR while disabled:
+	 * 	- Count OSCERCLK divided down to LPTMR_TIMEOUT_HZ
+	 * 	- Interrupt when the timeout is up, which wakes the MCU
+	 */
+	LPTMR0->CSR = 0;
+	LPTMR0->PSR = LPTMR_PSR_PCS(LPTMR_PCS_OSCERCLK) | LPTMR_PSR_PRESCALE(lptmr_timeout_prescale);
+	LPTMR0->CMR = timeout_us - 1;
+	NVIC_ClearPendingIRQ(LPTMR0_IRQn);
+	NVIC_EnableIRQ(LPTMR0_IRQn);
+	LPTMR0->CSR = LPTMR_CSR_TIE_MASK | LPTMR_CSR_TEN_MASK;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+uint32_t stop_lptmr_timeout(void){
+
+	/**
+	 * Used to hold the time since the timeout started
+	 */
+	uint32_t elapsed_us;
+
+
+
+	/**
+	 * Read the count (CNR must be written to latch it), counting the compare
+	 * if it passed, then stop the LPTMR, which clears TCF
+	 */
+	LPTMR0->CNR = 0;
+	elapsed_us = LPTMR0->CNR;
+	if(LPTMR0->CSR & LPTMR_CSR_TCF_MASK){
+		elapsed_us += lptmr_timeout_us;
+	}
+	LPTMR0->CSR = 0;
+	NVIC_DisableIRQ(LPTMR0_IRQn);
+	NVIC_ClearPendingIRQ(LPTMR0_IRQn);
+	lptmr_in_use = false;
+
+	return elapsed_us;
+}
+
+
+
+void LPTMR0_IRQHandler(void){
+
+	/**
+	 * Acknowledge the compare (TCF is write 1 to clear) and hand it to the
+	 * fixed rate user. A timeout never gets here
+	 */
+	LPTMR0->CSR |= LPTMR_CSR_TCF_MASK;
+	if(lptmr_handler != NULL){
+		lptmr_handler();
+	}
+}
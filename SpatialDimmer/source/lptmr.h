@@ -0,0 +1,98 @@
+/**
+ * @file	lptmr.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros and function headers for sharing the low-power timer
+ */
+
+
+
+#ifndef LPTMR_H_
+#define LPTMR_H_
+
+
+
+/**
+ * @brief	LPTMR PSR[PCS] value selecting OSCERCLK, the only LPTMR clock
+ * 			that is both exact and kept running in stop modes
+ */
+#define LPTMR_PCS_OSCERCLK\
+	(3)
+
+
+
+/**
+ * @brief	The rate the LPTMR counts at while timing a timeout, in Hz
+ */
+#define LPTMR_TIMEOUT_HZ\
+	(1000000)
+
+
+
+/**
+ * @brief	The longest timeout in us, a full 16-bit compare
+ */
+#define LPTMR_TIMEOUT_MAX_US\
+	(LPTMR_CMR_COMPARE_MASK + 1)
+
+
+
+/**
+ * @brief	Clock the LPTMR, keep OSCERCLK running in stop modes and work out
+ * 			the prescaler for timeouts
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if OSCERCLK is off or is not a power
+ * 			of two multiple of LPTMR_TIMEOUT_HZ, in which case timeouts cannot
+ * 			be started
+ */
+int init_lptmr(void);
+
+
+
+/**
+ * @brief	Start interrupting at a fixed rate
+ * @param	hz - The rate in Hz, which must divide OSCERCLK exactly
+ * @param	handler - Called from the LPTMR interrupt at each compare, at
+ * 			DEFERRED_URGENT_PRIORITY
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if the LPTMR is in use or cannot be
+ * 			clocked at hz
+ * @detail
+ * 		Counts OSCERCLK directly, resetting on each compare so every period
+ * 		is exactly OSCERCLK / hz counts. The LPTMR stays in use until
+ * 		stop_lptmr_periodic()
+ */
+int start_lptmr_periodic(uint32_t hz, void (*handler)(void));
+
+
+
+/**
+ * @brief	Stop interrupting at a fixed rate and free the LPTMR
+ */
+void stop_lptmr_periodic(void);
+
+
+
+/**
+ * @brief	Start a one-shot timeout that wakes the MCU from stop modes
+ * @param	timeout_us - How long until the timeout, between 1 and
+ * 			LPTMR_TIMEOUT_MAX_US
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if the LPTMR is in use, timeouts
+ * 			cannot be timed or timeout_us is out of range
+ * @detail
+ * 		Call with interrupts masked. The interrupt only wakes the MCU and is
+ * 		never taken, since stop_lptmr_timeout() clears it before interrupts
+ * 		are unmasked
+ */
+int start_lptmr_timeout(uint32_t timeout_us);
+
+
+
+/**
+ * @brief	Stop the timeout and free the LPTMR
+ * @return	Microseconds since start_lptmr_timeout(), counting the whole
+ * 			timeout if it passed
+ */
+uint32_t stop_lptmr_timeout(void);
+
+
+
+#endif /* LPTMR_H_ */
@@ -57,11 +57,126 @@
 /**
  * Include user-defined libraries
  */
+#include "benchmark.h"
 #include "bitops.h"
+#include "calibration.h"
+#include "console.h"
+#include "deferred.h"
+#include "idle.h"
 #include "led.h"
 #include "tpm.h"
 #include "i2c.h"
+#include "lptmr.h"
+#include "pipeline.h"
 #include "mma8451q.h"
+#include "curve.h"
+#include "motion.h"
+#include "orientation.h"
+#include "sampling.h"
+#include "scheduler.h"
+#include "timebase.h"
+#include "watchdog.h"
+#include "ws2812.h"
+
+
+
+/**
+ * @brief	How many ticks between telemetry prints. Build with TELEMETRY_FLOOD
+ * 			to print on every tick, keeping the debug UART saturated so the
+ * 			latencies printed show how the urgent path holds up under it
+ */
+#ifdef TELEMETRY_FLOOD
+#define TELEMETRY_PERIOD_TICKS\
+	(1)
+#else
+#define TELEMETRY_PERIOD_TICKS\
+	(SCHEDULER_TICK_HZ)
+#endif
+
+
+
+/**
+ * @brief	Telemetry task: print the time since boot, the sample timing, the
+ * 			interrupt latencies, the time spent idle, the newest XYZ values
+ * 			and RGB levels, and how the scheduler is keeping up
+ */
+static void run_telemetry_task(void){
+
+	/**
+	 * Used to hold the time since boot, the sample timing, the latencies and
+	 * the idle residency
+	 */
+	uint64_t now_us = get_timebase_us();
+	sampling_jitter_t jitter;
+	latency_t deferred_latency;
+	uint32_t pwm_max_cycles;
+	uint32_t pwm_average_cycles;
+	idle_residency_t residency;
+
+	get_sampling_jitter(&jitter);
+	get_deferred_latency(&deferred_latency);
+	get_pwm_commit_latency(&pwm_max_cycles, &pwm_average_cycles);
+	get_idle_residency(&residency);
+	reset_idle_residency();
+	printf("T = %lu.%06lu s\r\n", (unsigned long)(now_us / TIMEBASE_HZ), (unsigned long)(now_us % TIMEBASE_HZ));
+	printf("SAMPLING %s: %lu gaps, %ld us mean, %lu us stddev, %lu us max deviation, %lu dropped\r\n",
+		timed_sampling_active ? "timed" : (sampling_resting ? "resting" : "int1"),
+		(unsigned long)jitter.intervals,
+		(long)jitter.mean_deviation_us,
+		(unsigned long)jitter.stddev_us,
+		(unsigned long)jitter.max_deviation_us,
+		(unsigned long)jitter.dropped);
+	printf("LATENCY pwm commit %lu avg, %lu max cycles; deferred %lu avg, %lu max us\r\n",
+		(unsigned long)pwm_average_cycles,
+		(unsigned long)pwm_max_cycles,
+		(unsigned long)((deferred_latency.count > 0) ? (deferred_latency.total / deferred_latency.count) : 0),
+		(unsigned long)deferred_latency.max);
+	printf("IDLE wait %lu/1000 in %lu, vlps %lu/1000 in %lu\r\n",
+		(unsigned long)((residency.window_us > 0) ? ((residency.us[idle_wait] * 1000) / residency.window_us) : 0),
+		(unsigned long)residency.entries[idle_wait],
+		(unsigned long)((residency.window_us > 0) ? ((residency.us[idle_vlps] * 1000) / residency.window_us) : 0),
+		(unsigned long)residency.entries[idle_vlps]);
+	printf("XYZ = (%d, %d, %d)\r\n", current_x, current_y, current_z);
+	printf("RGB = (%d, %d, %d)\r\n", current_red_level, current_green_level, current_blue_level);
+	print_scheduler_stats();
+}
+
+
+
+/**
+ * @brief	Console event task: hand each received character to the console
+ * 			commands
+ */
+static void handle_console_event(const event_t *event){
+
+	receive_console_char((char)event->data);
+}
+
+
+
+/**
+ * @brief	The tasks of the processing path, in the order they run when due
+ * 			on the same tick or woken by the same event
+ * @detail
+ * 		sample:		Collects the samples acquired at the 800 Hz output
+ * 					data rate, so a block of 8 fills every 10 ms
+ * 		filter:		Remaps and filters each full block
+ * 		render:		Maps and outputs each filtered block. Starts on the same
+ * 					tick as filter, so it runs straight after it
+ * 		console:	Handles console commands as characters arrive
+ * 		telemetry:	Prints over the debug console
+ *
+ * 		The processing path must keep finishing runs within 200 ms, which
+ * 		leaves room for telemetry holding up the main loop while it prints.
+ * 		The console goes unsupervised, since there may be no input
+ */
+static scheduler_task_t scheduler_tasks[] = {
+	{.name = "sample", .run = run_sample_task, .period_ticks = 1, .deadline_ticks = 20, .budget_us = 1000},
+	{.name = "filter", .run = run_filter_task, .period_ticks = 1, .deadline_ticks = 20, .budget_us = 1000},
+	{.name = "render", .run = run_render_task, .period_ticks = 1, .deadline_ticks = 20, .budget_us = 5000},
+	{.name = "console", .handle = handle_console_event, .event = event_uart_byte},
+	{.name = "telemetry", .run = run_telemetry_task, .period_ticks = TELEMETRY_PERIOD_TICKS, .deadline_ticks = 2 * SCHEDULER_TICK_HZ}
+};
 
 
 
@@ -75,6 +190,13 @@ int main(void){
 	 */
 	volatile int return_code;
 
+
+
+	/**
+	 * Used to hold why the watchdog reset the MCU last time, if it did
+	 */
+	watchdog_record_t watchdog_record;
+
 	/**
 	 * Init board hardware
 	 */
@@ -94,6 +216,63 @@ int main(void){
 
 
 
+	/**
+	 * Set the watchdog timeout before anything can hang, and say if it is
+	 * what reset the MCU last time, and why the scheduler or idle let it
+	 */
+	init_watchdog();
+	if(was_watchdog_reset()){
+		printf("Reset by watchdog\r\n");
+	}
+	if(take_watchdog_record(&watchdog_record)){
+		if(watchdog_record.cause == watchdog_pll_unlocked){
+			printf("WATCHDOG PLL did not lock again after VLPS\r\n");
+		}
+		else{
+			printf("WATCHDOG %s missed its %u tick deadline by %lu ticks while running %s, %lu ticks after start\r\n",
+				watchdog_record.late_task,
+				(unsigned int)watchdog_record.deadline_ticks,
+				(unsigned long)(watchdog_record.late_ticks - watchdog_record.deadline_ticks),
+				(watchdog_record.running_task[0] != '\0') ? watchdog_record.running_task : "no task",
+				(unsigned long)watchdog_record.uptime_ticks);
+		}
+	}
+
+
+
+	/**
+	 * Start the microsecond timebase early so everything after can use it
+	 */
+	return_code = init_timebase();
+	if(return_code != EXIT_SUCCESS){
+		return(EXIT_FAILURE);
+	}
+
+
+
+	/**
+	 * Let urgent interrupts defer their slow work to PendSV
+	 */
+	init_deferred_work();
+
+
+
+	/**
+	 * Share the LPTMR between timed sampling and timing VLPS. Without it
+	 * sampling stays on INT1 and idle falls back to WAIT, so a failure is
+	 * not fatal
+	 */
+	init_lptmr();
+
+
+
+	/**
+	 * Let the scheduler idle in VLPS when nothing needs the clocks it stops
+	 */
+	init_idle();
+
+
+
 	/**
 	 * Initialize on-board LEDs
 	 */
@@ -109,109 +288,86 @@ int main(void){
 	 * 	- TPM2 channel 1 connects to green on-board LED
 	 * 	- TPM0 channel 1 connects to blue on-board LED
 	 */
-	init_onboard_tpm2(TPM2_RED_LED_CHANNEL, TPM_MOD);
-	init_onboard_tpm2(TPM2_GREEN_LED_CHANNEL, TPM_MOD);
-	init_onboard_tpm0(TPM0_BLUE_LED_CHANNEL, TPM_MOD);
+	init_onboard_tpm();
 
 
 
 	/**
-	 * Initialize on-board I2C0
+	 * Initialize the WS2812 strip on PTD2. The on-board LEDs work without
+	 * it, so a failure is not fatal
 	 */
-	init_onboard_i2c0();
+	init_ws2812();
 
 
 
 	/**
-	 * Initialize on-board accelerometer
+	 * Load the mounting orientation saved in flash
 	 */
-	return_code = init_onboard_accelerometer();
-	if(return_code != EXIT_SUCCESS){
-		return(EXIT_FAILURE);
-	}
+	init_orientation();
 
 
 
 	/**
-	 * Enter an infinite loop where accelerometer values will be
-	 * read and RGB LED will be set according to XYZ values
+	 * Load the LED color calibration saved in flash, and take console
+	 * commands from the debug UART
 	 */
-	while(1) {
+	init_calibration();
+	init_console();
 
-		/**
-		 * Read XYZ values from on-board accelerometer
-		 */
-		read_onboard_accelerometer_values();
-		printf("XYZ = (%d, %d, %d)\r\n", current_x, current_y, current_z);
 
 
+	/**
+	 * Initialize response curves used by mapping_curve
+	 */
+	init_curves();
+
 
-		/**
-		 * Calculate new RGB levels from current XYZ values
-		 */
-		calculate_rgb_from_xyz(x, red);
-		calculate_rgb_from_xyz(y, green);
-		calculate_rgb_from_xyz(z, blue);
-		printf("RGB = (%d, %d, %d)\r\n\n", current_red_level, current_green_level, current_blue_level);
 
+	/**
+	 * Initialize on-board I2C0
+	 */
+	init_onboard_i2c0();
 
 
-		/**
-		 * Set new RGB levels to physical RGB LED
-		 */
-		analog_control_onboard_leds(red, analog_set);
-		analog_control_onboard_leds(green, analog_set);
-		analog_control_onboard_leds(blue, analog_set);
 
+	/**
+	 * Initialize on-board accelerometer
+	 */
+	return_code = init_onboard_accelerometer();
+	if(return_code != EXIT_SUCCESS){
+		return(EXIT_FAILURE);
+	}
 
 
-		/**
-		 * Delay for testing
-		 */
-		for(int i = 0; i < 1250000; i++);
 
+#ifdef BENCHMARK
 
+	/**
+	 * Print cycle counts of the processing path before the scheduler starts
+	 */
+	run_benchmarks();
+#endif
 
-		/**
-		for(int i = 0; i < 125000; i++);
-		if(current_red_level >= RGB_MAX || current_red_level <= RGB_MIN){
-			step_red_level = (-step_red_level);
-		}
-		if(current_green_level >= RGB_MAX || current_green_level <= RGB_MIN){
-			step_green_level = (-step_green_level);
-		}
-		if(current_blue_level >= RGB_MAX || current_blue_level <= RGB_MIN){
-			step_blue_level = (-step_blue_level);
-		}
 
-		current_red_level += step_red_level;
-		current_green_level += step_green_level;
-		current_blue_level += step_blue_level;
 
-		if(current_red_level < RGB_MIN){
-			current_red_level = RGB_MIN;
-		}
-		else if(current_red_level > RGB_MAX){
-			current_red_level = RGB_MAX;
-		}
+	/**
+	 * Start acquiring samples. From here on only the acquisition triggers
+	 * use I2C
+	 */
+	start_sampling();
 
-		if(current_green_level < RGB_MIN){
-			current_green_level = RGB_MIN;
-		}
-		else if(current_green_level > RGB_MAX){
-			current_green_level = RGB_MAX;
-		}
 
-		if(current_blue_level < RGB_MIN){
-			current_blue_level = RGB_MIN;
-		}
-		else if(current_blue_level > RGB_MAX){
-			current_blue_level = RGB_MAX;
-		}
 
-		analog_control_onboard_leds(white, analog_set);
-		 */
+	/**
+	 * Hand the processing path to the scheduler, which runs each task at its
+	 * own rate or on its event, sleeps in between and feeds the watchdog
+	 * while every task keeps to its deadline
+	 */
+	return_code = init_scheduler(scheduler_tasks, (uint8_t)(sizeof(scheduler_tasks) / sizeof(scheduler_tasks[0])));
+	if(return_code != EXIT_SUCCESS){
+		return(EXIT_FAILURE);
 	}
+	run_scheduler();
 
 
 
@@ -20,7 +20,10 @@
  * User-defined libraries
  */
 #include "bitops.h"
+#include "deferred.h"
+#include "delay.h"
 #include "led.h"		// Keep led.h included before mma8451q.h for led_color_t typedef
+#include "pipeline.h"	// Keep pipeline.h included before mma8451q.h for sample_block_t typedef
 #include "mma8451q.h"
 #include "i2c.h"
 #include "tpm.h"
@@ -51,6 +54,34 @@
 
 
 
+/**
+ * @brief	Address of STATUS register for MMA8451Q
+ */
+#define STATUS_REG\
+	(0x00)
+
+
+
+/**
+ * @brief	STATUS[3] - X, Y, Z-axis new data ready
+ * @detail
+ * 		0: No new set of data ready
+ * 		1: A new set of data is ready
+ */
+#define STATUS_ZYXDR\
+	(MASK(1UL, 3))
+
+
+
+/**
+ * @brief	How long in us to wait after WHO_AM_I answers before configuring
+ * 			CTRL1, covering the accelerometer's boot after power-up
+ */
+#define MMA8451Q_BOOT_US\
+	(1000)
+
+
+
 /**
  * @brief	Address of X[13:8] data register for MMA8451Q
  */
@@ -183,9 +214,117 @@
 
 
 /**
- * @brief	The total amount of possible XYZ values
+ * @brief	Address of CTRL4 register for MMA8451Q
  */
-int xyz_levels = ((XYZ_MAX - XYZ_MIN) + 1);
+#define CTRL4_REG_ADDRESS\
+	(0x2D)
+
+
+
+/**
+ * @brief	CTRL4[0] - Data-ready interrupt enable
+ * @detail
+ * 		0: Data-ready interrupt disabled
+ * 		1: Data-ready interrupt enabled
+ */
+#define CTRL4_INT_EN_DRDY\
+	(MASK(1UL, 0))
+
+
+
+/**
+ * @brief	Address of CTRL5 register for MMA8451Q
+ */
+#define CTRL5_REG_ADDRESS\
+	(0x2E)
+
+
+
+/**
+ * @brief	CTRL5[0] - Data-ready interrupt routing
+ * @detail
+ * 		0: Routed to INT2
+ * 		1: Routed to INT1
+ */
+#define CTRL5_INT_CFG_DRDY\
+	(MASK(1UL, 0))
+
+
+
+/**
+ * @brief	The PORTA pin wired to INT1 of MMA8451Q (PTA14). INT1 is active
+ * 			low and stays low until the sample is read
+ */
+#define INT1_PIN\
+	(14)
+
+
+
+/**
+ * @brief	PORTA PCR[IRQC] value to interrupt on a falling edge
+ */
+#define INT1_IRQC_FALLING_EDGE\
+	(0xA)
+
+
+
+/**
+ * @brief	True when both XYZ and RGB ranges are powers of two, in which
+ * 			case mapping between them is a single shift
+ */
+#define XYZ_RGB_POWERS_OF_TWO\
+	((((XYZ_LEVELS) & ((XYZ_LEVELS) - 1)) == 0) &&\
+	(((RGB_LEVELS) & ((RGB_LEVELS) - 1)) == 0))
+
+
+
+#if XYZ_RGB_POWERS_OF_TWO
+/**
+ * @brief	The amount to shift an offset XYZ value by to get an RGB level.
+ * 			Folded to a constant by the compiler
+ */
+#if (XYZ_LEVELS >= RGB_LEVELS)
+#define XYZ_TO_RGB_SHIFT\
+	(__builtin_ctz((XYZ_LEVELS) / (RGB_LEVELS)))
+#else
+#define RGB_FROM_XYZ_SHIFT\
+	(__builtin_ctz((RGB_LEVELS) / (XYZ_LEVELS)))
+#endif
+#else
+/**
+ * @brief	Scale from an offset XYZ value to an RGB level in Q16, computed
+ * 			at build time so mapping needs only a multiply and shift
+ */
+#define XYZ_TO_RGB_SCALE_Q16\
+	((uint32_t)(((uint64_t)(RGB_LEVELS) << 16) / (XYZ_LEVELS)))
+#endif
+
+
+
+/**
+ * @brief	Map an offset XYZ value to an RGB level, resolved at build time
+ */
+#if XYZ_RGB_POWERS_OF_TWO
+#if (XYZ_LEVELS >= RGB_LEVELS)
+#define XYZ_TO_RGB(xyz)\
+	((int16_t)((xyz) >> XYZ_TO_RGB_SHIFT))
+#else
+#define XYZ_TO_RGB(xyz)\
+	((int16_t)((xyz) << RGB_FROM_XYZ_SHIFT))
+#endif
+#else
+#define XYZ_TO_RGB(xyz)\
+	((int16_t)(((uint32_t)(xyz) * XYZ_TO_RGB_SCALE_Q16) >> 16))
+#endif
+
+
+
+/**
+ * @brief	How XYZ values are currently mapped to RGB levels. Written by the
+ * 			console task and read by the render task, which both run from the
+ * 			main loop, so a change takes effect from the next block
+ */
+mapping_mode_t mapping_mode = mapping_axis;
 
 
 
@@ -213,6 +352,13 @@ int16_t current_z = 0;
 
 
 
+/**
+ * @brief	Called from the INT1 interrupt
+ */
+static void (*mma8451q_handler)(void) = NULL;
+
+
+
 int init_onboard_accelerometer(void){
 
 	/**
@@ -238,21 +384,100 @@ int init_onboard_accelerometer(void){
 
 
 	/**
-	 * Configure on-board accelerometer
+	 * Configure on-board accelerometer, routing data-ready to INT1 while
+	 * still in standby since CTRL4 and CTRL5 cannot be written once active
 	 */
-	if(i2c0_read_byte(MMA8451Q_ADDRESS, WHO_AM_I_REG) == DEVICE_ID){
-		for(int i = 0; i < 1250000; i++);
-		i2c0_write_byte(MMA8451Q_ADDRESS, CTRL1_REG_ADDRESS, data);
-		return EXIT_SUCCESS;
-	}
-	else{
+	if(i2c0_read_byte(MMA8451Q_ADDRESS, WHO_AM_I_REG) != DEVICE_ID){
 		return EXIT_FAILURE;
 	}
+	delay_us(MMA8451Q_BOOT_US);
+	i2c0_write_byte(MMA8451Q_ADDRESS, CTRL4_REG_ADDRESS, CTRL4_INT_EN_DRDY);
+	i2c0_write_byte(MMA8451Q_ADDRESS, CTRL5_REG_ADDRESS, CTRL5_INT_CFG_DRDY);
+	i2c0_write_byte(MMA8451Q_ADDRESS, CTRL1_REG_ADDRESS, data);
+
+
+
+	/**
+	 * Set INT1 up as an input, driven push-pull so no pull-up is needed. Its
+	 * interrupt is left off until sampling starts, as an urgent interrupt
+	 * that reads the sample itself
+	 */
+	SIM->SCGC5 |= SIM_SCGC5_PORTA_MASK;
+	enable_onboard_accelerometer_interrupt(false);
+	GPIOA->PDDR &= ~MASK(1UL, INT1_PIN);
+	NVIC_SetPriority(PORTA_IRQn, DEFERRED_URGENT_PRIORITY);
+	NVIC_ClearPendingIRQ(PORTA_IRQn);
+	NVIC_EnableIRQ(PORTA_IRQn);
+
+	return EXIT_SUCCESS;
+}
+
+
+
+void enable_onboard_accelerometer_interrupt(bool enable){
+
+	/**
+	 * Clear any edge seen while disabled, so it is not taken as a new sample
+	 */
+	PORTA->PCR[INT1_PIN] = PORT_PCR_MUX(1) | PORT_PCR_ISF_MASK | PORT_PCR_IRQC(enable ? INT1_IRQC_FALLING_EDGE : 0);
+}
+
+
+
+void set_onboard_accelerometer_rate(accelerometer_rate_t rate){
+
+	/**
+	 * Used to hold CTRL1 configured as at initialization, at the new rate
+	 */
+	uint8_t data =
+		CTRL1_ASLP_RATE |
+		MASK((uint32_t)rate, 3) |
+		CTRL1_LNOISE |
+		CTRL1_F_READ;
+
+
+
+	/**
+	 * Drop to standby to change the rate, then go active again
+	 */
+	i2c0_write_byte(MMA8451Q_ADDRESS, CTRL1_REG_ADDRESS, data);
+	i2c0_write_byte(MMA8451Q_ADDRESS, CTRL1_REG_ADDRESS, data | CTRL1_ACTIVE);
+}
+
+
+
+void set_onboard_accelerometer_handler(void (*handler)(void)){
+
+	mma8451q_handler = handler;
+}
+
+
+
+void pend_onboard_accelerometer_interrupt(void){
+
+	NVIC_SetPendingIRQ(PORTA_IRQn);
 }
 
 
 
-void read_onboard_accelerometer_values(void){
+void PORTA_IRQHandler(void){
+
+	/**
+	 * Acknowledge the edge if there was one (ISF is write 1 to clear). The
+	 * interrupt may also have been pended without one, so the handler is
+	 * called either way
+	 */
+	if(PORTA->ISFR & MASK(1UL, INT1_PIN)){
+		PORTA->ISFR = MASK(1UL, INT1_PIN);
+	}
+	if(mma8451q_handler != NULL){
+		mma8451q_handler();
+	}
+}
+
+
+
+void read_onboard_accelerometer_sample(int16_t *x_value, int16_t *y_value, int16_t *z_value){
 
 	/**
 	 * Used to hold XYZ data bytes from on-board accelerometer
@@ -315,33 +540,27 @@ void read_onboard_accelerometer_values(void){
 	/**
 	 * Align the calculated data from 16-bits to 14-bits
 	 */
-	current_x = (x_temp >> 2);
-	current_y = (y_temp >> 2);
-	current_z = (z_temp >> 2);
+	*x_value = (x_temp >> 2);
+	*y_value = (y_temp >> 2);
+	*z_value = (z_temp >> 2);
 }
 
 
 
-void calculate_rgb_from_xyz(accelerometer_axis_t accelerometer_axis, led_color_t led_color){
+bool is_onboard_accelerometer_ready(void){
+
+	return ((i2c0_read_byte(MMA8451Q_ADDRESS, STATUS_REG) & STATUS_ZYXDR) != 0);
+}
 
-	/**
-	 * Used to hold values for XYZ to RGB calculations
-	 */
-	int32_t xyz;
-	int32_t xyz_offset;
-	int32_t rgb;
 
 
+void calculate_rgb_from_xyz(accelerometer_axis_t accelerometer_axis, led_color_t led_color){
 
 	/**
-	 * Calculate XYZ offset
+	 * Used to hold values for XYZ to RGB calculations
 	 */
-	if(XYZ_MIN >= 0){
-		xyz_offset = 0;
-	}
-	else{
-		xyz_offset = -(XYZ_MIN);
-	}
+	int32_t xyz = 0;
+	int32_t rgb;
 
 
 
@@ -350,13 +569,13 @@ void calculate_rgb_from_xyz(accelerometer_axis_t accelerometer_axis, led_color_t
 	 */
 	switch(accelerometer_axis){
 	case x:
-		xyz = current_x + xyz_offset;
+		xyz = current_x + XYZ_OFFSET;
 		break;
 	case y:
-		xyz = current_y + xyz_offset;
+		xyz = current_y + XYZ_OFFSET;
 		break;
 	case z:
-		xyz = current_z + xyz_offset;
+		xyz = current_z + XYZ_OFFSET;
 		break;
 	default:
 		break;
@@ -365,17 +584,9 @@ void calculate_rgb_from_xyz(accelerometer_axis_t accelerometer_axis, led_color_t
 
 
 	/**
-	 * Map according to ranges of XYZ and RGB
+	 * Map according to ranges of XYZ and RGB, resolved at build time
 	 */
-	if(rgb_levels == xyz_levels){
-
-	}
-	else if(rgb_levels > xyz_levels){
-
-	}
-	else if(rgb_levels < xyz_levels){
-		rgb = xyz / (xyz_levels / rgb_levels);
-	}
+	rgb = XYZ_TO_RGB(xyz);
 
 
 
@@ -396,3 +607,23 @@ void calculate_rgb_from_xyz(accelerometer_axis_t accelerometer_axis, led_color_t
 		break;
 	}
 }
+
+
+
+void calculate_rgb_block_from_xyz(const sample_block_t *sample_block, rgb_block_t *rgb_block){
+
+	/**
+	 * Map each axis in its own tight loop, resolved at build time the same
+	 * way as calculate_rgb_from_xyz()
+	 */
+	for(int i = 0; i < sample_block->count; i++){
+		rgb_block->red[i] = XYZ_TO_RGB(sample_block->x[i] + XYZ_OFFSET);
+	}
+	for(int i = 0; i < sample_block->count; i++){
+		rgb_block->green[i] = XYZ_TO_RGB(sample_block->y[i] + XYZ_OFFSET);
+	}
+	for(int i = 0; i < sample_block->count; i++){
+		rgb_block->blue[i] = XYZ_TO_RGB(sample_block->z[i] + XYZ_OFFSET);
+	}
+	rgb_block->count = sample_block->count;
+}
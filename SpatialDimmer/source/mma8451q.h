@@ -21,6 +21,44 @@ typedef enum accelerometer_axis_e{
 
 
 
+/**
+ * @brief	Used to select the on-board accelerometer output data rate, in
+ * 			the order of CTRL1[DR]
+ */
+typedef enum accelerometer_rate_e{
+	accelerometer_800hz,
+	accelerometer_400hz,
+	accelerometer_200hz,
+	accelerometer_100hz,
+	accelerometer_50hz,
+	accelerometer_12hz5,
+	accelerometer_6hz25,
+	accelerometer_1hz56
+} accelerometer_rate_t;
+
+
+
+/**
+ * @brief	Used to select how XYZ values are mapped to RGB levels
+ * @detail
+ * 		mapping_axis:	Each axis drives one LED color (x to red, y to green
+ * 						and z to blue)
+ * 		mapping_motion:	Gravity-removed acceleration magnitude drives all
+ * 						LED colors (see motion.h)
+ * 		mapping_curve:	Each axis drives one LED color through that color's
+ * 						response curve (see curve.h)
+ * 		mapping_hsv:	Tilt direction drives hue, and tilt amount drives
+ * 						saturation and value (see hsv.h)
+ */
+typedef enum mapping_mode_e{
+	mapping_axis,
+	mapping_motion,
+	mapping_curve,
+	mapping_hsv
+} mapping_mode_t;
+
+
+
 /**
  * @brief	Lowest possible value when working with XYZ (14-bit resolution)
  */
@@ -37,10 +75,26 @@ typedef enum accelerometer_axis_e{
 
 
 
+/**
+ * @brief	The total amount of possible XYZ values
+ */
+#define XYZ_LEVELS\
+	((XYZ_MAX - XYZ_MIN) + 1)
+
+
+
+/**
+ * @brief	Offset added to an XYZ value so XYZ_MIN maps to 0
+ */
+#define XYZ_OFFSET\
+	((XYZ_MIN >= 0) ? 0 : -(XYZ_MIN))
+
+
+
 /**
  * @brief	Defined in mma8451q.c
  */
-extern int xyz_levels;
+extern mapping_mode_t mapping_mode;
 
 
 
@@ -69,6 +123,9 @@ extern int16_t current_z;
  * @brief	Initialize the on-board accelerometer
  * @return	EXIT_SUCCESS or EXIT_FAILURE
  * @detail
+ * 		Each new sample pulls INT1 (PTA14) low. Its interrupt is set up but
+ * 		left off until enable_onboard_accelerometer_interrupt()
+ *
  * 		Many operations were referenced from Alexander G Dean (Chapter 8 of
  * 		Embedded Systems Fundamentals with ARM Cortex-M Based Microcontrollers)
  */
@@ -77,12 +134,60 @@ int init_onboard_accelerometer(void);
 
 
 /**
- * @brief	Read the values from on-board accelerometer
+ * @brief	Turn the INT1 interrupt on or off
+ * @param	enable - true to call the INT1 handler on each new sample
+ */
+void enable_onboard_accelerometer_interrupt(bool enable);
+
+
+
+/**
+ * @brief	Set what the INT1 interrupt calls
+ * @param	handler - Called at DEFERRED_URGENT_PRIORITY on each new sample,
+ * 			and when pend_onboard_accelerometer_interrupt() is called
+ */
+void set_onboard_accelerometer_handler(void (*handler)(void));
+
+
+
+/**
+ * @brief	Run the INT1 handler as if a sample had come, even while INT1 is
+ * 			turned off
+ */
+void pend_onboard_accelerometer_interrupt(void);
+
+
+
+/**
+ * @brief	Change the output data rate
+ * @param	rate - The new output data rate
+ * @detail
+ * 		CTRL1[DR] only takes a write in standby, so the accelerometer stops
+ * 		for the two writes and the next sample comes a new period after
+ */
+void set_onboard_accelerometer_rate(accelerometer_rate_t rate);
+
+
+
+/**
+ * @brief	Read one XYZ sample from on-board accelerometer in a single burst
+ * @param	x_value - Where to store the x value
+ * @param	y_value - Where to store the y value
+ * @param	z_value - Where to store the z value
  * @detail
+ * 		Reads whatever sample is current without checking STATUS[ZYXDR].
  * 		Many operations were referenced from Alexander G Dean (Chapter 8 of
  * 		Embedded Systems Fundamentals with ARM Cortex-M Based Microcontrollers)
  */
-void read_onboard_accelerometer_values(void);
+void read_onboard_accelerometer_sample(int16_t *x_value, int16_t *y_value, int16_t *z_value);
+
+
+
+/**
+ * @brief	Check STATUS[ZYXDR] for a new sample
+ * @return	true if a new sample is ready to read, otherwise false
+ */
+bool is_onboard_accelerometer_ready(void);
 
 
 
@@ -90,9 +195,24 @@ void read_onboard_accelerometer_values(void);
  * @brief	Map an XYZ value to RGB level(s)
  * @param	accelerometer_axis - The XYZ value to map from
  * @param	led_color - The LED color(s) to map to
+ * @detail
+ * 		The mapping is resolved at build time from XYZ_LEVELS and RGB_LEVELS.
+ * 		When both ranges are powers of two it reduces to a single shift,
+ * 		otherwise to a multiply by a Q16 scale constant. Neither needs a
+ * 		divide, which the Cortex-M0+ only has as a library call
  */
 void calculate_rgb_from_xyz(accelerometer_axis_t accelerometer_axis, led_color_t led_color);
 
 
 
+/**
+ * @brief	Map a block of XYZ samples to RGB levels with x to red, y to green
+ * 			and z to blue
+ * @param	sample_block - The block to map from
+ * @param	rgb_block - The block to map to
+ */
+void calculate_rgb_block_from_xyz(const sample_block_t *sample_block, rgb_block_t *rgb_block);
+
+
+
 #endif /* MMA8451Q_H_ */
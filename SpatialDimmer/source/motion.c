@@ -0,0 +1,205 @@
+/**
+ * @file	motion.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for gravity-removed motion intensity
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "bitops.h"
+#include "led.h"		// Keep led.h included before mma8451q.h for led_color_t typedef
+#include "pipeline.h"	// Keep pipeline.h included before mma8451q.h for sample_block_t typedef
+#include "mma8451q.h"
+#include "motion.h"
+#include "sampling.h"
+#include "tpm.h"
+
+
+
+/**
+ * @brief	Both time constants must cover at least one sample
+ */
+#if (((MOTION_GRAVITY_MS * SAMPLING_HZ) < 1000) || ((MOTION_DECAY_MS * SAMPLING_HZ) < 1000))
+#error "MOTION_GRAVITY_MS and MOTION_DECAY_MS must each be at least one sample period"
+#endif
+
+
+
+/**
+ * @brief	Tracked gravity for each axis, scaled up by 2^MOTION_GRAVITY_SHIFT
+ * 			so the slow average keeps its fractional bits
+ */
+static int32_t gravity_x_scaled = 0;
+static int32_t gravity_y_scaled = 0;
+static int32_t gravity_z_scaled = 0;
+
+
+
+/**
+ * @brief	Used to seed the gravity estimate with the first sample
+ */
+static bool gravity_seeded = false;
+
+
+
+/**
+ * @brief	Current motion level between 0 and 255 after the decay envelope
+ */
+uint16_t current_motion_level = 0;
+
+
+
+uint16_t integer_sqrt(uint32_t value){
+
+	/**
+	 * Used to hold the partial root and the bit currently being tried
+	 */
+	uint32_t root = 0;
+	uint32_t bit = MASK(1UL, 30);
+
+
+
+	/**
+	 * Try each result bit from the highest down, always 16 iterations
+	 */
+	while(bit != 0){
+		if(value >= (root + bit)){
+			value -= (root + bit);
+			root = (root >> 1) + bit;
+		}
+		else{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return ((uint16_t)root);
+}
+
+
+
+/**
+ * @brief	Move the tracked gravity vector towards a sample
+ * @param	x_value - The x value of the sample
+ * @param	y_value - The y value of the sample
+ * @param	z_value - The z value of the sample
+ */
+static inline void motion_track_gravity(int16_t x_value, int16_t y_value, int16_t z_value){
+
+	/**
+	 * Seed with the first sample, otherwise move a fraction of the way
+	 * towards the sample
+	 */
+	if(!gravity_seeded){
+		gravity_x_scaled = ((int32_t)x_value << MOTION_GRAVITY_SHIFT);
+		gravity_y_scaled = ((int32_t)y_value << MOTION_GRAVITY_SHIFT);
+		gravity_z_scaled = ((int32_t)z_value << MOTION_GRAVITY_SHIFT);
+		gravity_seeded = true;
+	}
+	else{
+		gravity_x_scaled += x_value - (gravity_x_scaled >> MOTION_GRAVITY_SHIFT);
+		gravity_y_scaled += y_value - (gravity_y_scaled >> MOTION_GRAVITY_SHIFT);
+		gravity_z_scaled += z_value - (gravity_z_scaled >> MOTION_GRAVITY_SHIFT);
+	}
+}
+
+
+
+/**
+ * @brief	Update the motion level from the gravity-removed magnitude of a sample
+ * @param	x_value - The x value of the sample
+ * @param	y_value - The y value of the sample
+ * @param	z_value - The z value of the sample
+ * @return	The new motion level
+ */
+static inline uint16_t motion_step(int16_t x_value, int16_t y_value, int16_t z_value){
+
+	/**
+	 * Used to hold the dynamic (gravity-removed) acceleration per axis
+	 */
+	int32_t dynamic_x, dynamic_y, dynamic_z;
+
+
+
+	/**
+	 * Used to hold the motion energy and resulting level
+	 */
+	uint32_t energy;
+	uint32_t level;
+	uint32_t decayed;
+
+
+
+	/**
+	 * Remove gravity from each axis. Each term fits in 15 bits, so the sum
+	 * of squares stays well within 32 bits
+	 */
+	dynamic_x = x_value - (gravity_x_scaled >> MOTION_GRAVITY_SHIFT);
+	dynamic_y = y_value - (gravity_y_scaled >> MOTION_GRAVITY_SHIFT);
+	dynamic_z = z_value - (gravity_z_scaled >> MOTION_GRAVITY_SHIFT);
+
+	energy = integer_sqrt(
+		(uint32_t)(dynamic_x * dynamic_x) +
+		(uint32_t)(dynamic_y * dynamic_y) +
+		(uint32_t)(dynamic_z * dynamic_z));
+
+
+
+	/**
+	 * Scale to an RGB level
+	 */
+	level = (energy >> MOTION_LEVEL_SHIFT);
+	if(level > RGB_MAX){
+		level = RGB_MAX;
+	}
+
+
+
+	/**
+	 * Rise immediately with new motion, otherwise decay towards it
+	 */
+	decayed = current_motion_level;
+	if(decayed > 0){
+		decayed -= ((decayed >> MOTION_DECAY_SHIFT) + 1);
+	}
+	current_motion_level = (level > decayed) ? level : decayed;
+
+	return current_motion_level;
+}
+
+
+
+void calculate_rgb_block_from_motion(const sample_block_t *sample_block, rgb_block_t *rgb_block){
+
+	/**
+	 * Used to hold the motion level of each sample
+	 */
+	uint16_t level;
+
+
+
+	/**
+	 * Track gravity and step the envelope sample by sample, driving all
+	 * colors with the motion level
+	 */
+	for(int i = 0; i < sample_block->count; i++){
+		motion_track_gravity(sample_block->x[i], sample_block->y[i], sample_block->z[i]);
+		level = motion_step(sample_block->x[i], sample_block->y[i], sample_block->z[i]);
+		rgb_block->red[i] = level;
+		rgb_block->green[i] = level;
+		rgb_block->blue[i] = level;
+	}
+	rgb_block->count = sample_block->count;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file	motion.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros and function headers for gravity-removed motion intensity
+ */
+
+
+
+#ifndef MOTION_H_
+#define MOTION_H_
+
+
+
+/**
+ * @brief	How long gravity takes to be tracked, in ms
+ * @detail
+ * 		Gravity is tracked as a slow exponential average of each axis, with
+ * 		about this time constant. Larger values track gravity more slowly, so
+ * 		slow tilts are treated as motion for longer. Smaller values make the
+ * 		fixture less sensitive to slow movements
+ */
+#define MOTION_GRAVITY_MS\
+	(640)
+
+
+
+/**
+ * @brief	Each update moves the gravity estimate 1/2^MOTION_GRAVITY_SHIFT of
+ * 			the way towards the newest sample, the largest power of two of
+ * 			samples within MOTION_GRAVITY_MS at SAMPLING_HZ
+ */
+#define MOTION_GRAVITY_SHIFT\
+	(31 - __builtin_clz((MOTION_GRAVITY_MS * SAMPLING_HZ) / 1000))
+
+
+
+/**
+ * @brief	Motion energy is scaled down by 2^MOTION_LEVEL_SHIFT before being
+ * 			used as an RGB level
+ * @detail
+ * 		At 14-bit resolution 1g is 4096 counts, so a shift of 2 reaches
+ * 		RGB_MAX at roughly 0.25g of dynamic acceleration
+ */
+#define MOTION_LEVEL_SHIFT\
+	(2)
+
+
+
+/**
+ * @brief	How long the brightness envelope takes to decay, in ms, so pulses
+ * 			fade out instead of flickering
+ */
+#define MOTION_DECAY_MS\
+	(80)
+
+
+
+/**
+ * @brief	Each update the brightness envelope decays by 1/2^MOTION_DECAY_SHIFT
+ * 			of its current level, the largest power of two of samples within
+ * 			MOTION_DECAY_MS at SAMPLING_HZ
+ */
+#define MOTION_DECAY_SHIFT\
+	(31 - __builtin_clz((MOTION_DECAY_MS * SAMPLING_HZ) / 1000))
+
+
+
+/**
+ * @brief	Defined in motion.c
+ */
+extern uint16_t current_motion_level;
+
+
+
+/**
+ * @brief	Calculate the integer square root of a 32-bit value
+ * @param	value - The value to take the square root of
+ * @return	floor(sqrt(value))
+ * @detail
+ * 		Uses the bit-by-bit (digit) method, which only needs shifts, adds and
+ * 		compares. The loop always runs 16 times, so the cycle cost is bounded
+ * 		regardless of the input
+ */
+uint16_t integer_sqrt(uint32_t value);
+
+
+
+/**
+ * @brief	Map a block of XYZ samples to RGB levels by motion intensity
+ * @param	sample_block - The block to map from
+ * @param	rgb_block - The block to map to
+ * @detail
+ * 		Gravity is tracked and the envelope stepped sample by sample across
+ * 		the block, and all three LED colors are driven with the motion level
+ * 		so the fixture pulses with movement in any orientation
+ */
+void calculate_rgb_block_from_motion(const sample_block_t *sample_block, rgb_block_t *rgb_block);
+
+
+
+#endif /* MOTION_H_ */
@@ -0,0 +1,176 @@
+/**
+ * @file	nvm.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for configuration records kept in flash
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "board.h"
+#include "fsl_flash.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "nvm.h"
+
+
+
+/**
+ * @brief	Offset basis and prime of the 32-bit FNV-1a hash used as the
+ * 			record checksum
+ */
+#define NVM_CHECKSUM_BASIS\
+	(2166136261UL)
+#define NVM_CHECKSUM_PRIME\
+	(16777619UL)
+
+
+
+/**
+ * @brief	Header written in front of every record
+ */
+typedef struct nvm_header_s{
+	uint32_t magic;
+	uint32_t size;
+	uint32_t checksum;
+} nvm_header_t;
+
+
+
+/**
+ * @brief	End of the firmware image, defined by the linker script. Records
+ * 			are never written below it
+ */
+extern unsigned int _image_end;
+
+
+
+/**
+ * @brief	Flash driver state, initialized on the first write
+ */
+static flash_config_t nvm_flash_config;
+static bool nvm_flash_ready = false;
+
+
+
+/**
+ * @brief	Calculate the checksum of a record
+ * @param	data - The record
+ * @param	size - The size in bytes of the record
+ * @return	The 32-bit FNV-1a hash of the record
+ */
+static uint32_t nvm_checksum(const uint8_t *data, uint32_t size){
+
+	uint32_t hash = NVM_CHECKSUM_BASIS;
+
+	for(uint32_t i = 0; i < size; i++){
+		hash ^= data[i];
+		hash *= NVM_CHECKSUM_PRIME;
+	}
+
+	return hash;
+}
+
+
+
+int nvm_read_record(uint32_t sector_address, uint32_t magic, void *data, uint32_t size){
+
+	/**
+	 * Flash is memory-mapped, so the record can be read in place
+	 */
+	const nvm_header_t *header = (const nvm_header_t *)(uintptr_t)sector_address;
+	const uint8_t *record = (const uint8_t *)(header + 1);
+
+
+
+	/**
+	 * Reject anything that is not exactly the record expected
+	 */
+	if((header->magic != magic) || (header->size != size) || (size > NVM_MAX_RECORD_SIZE)){
+		return EXIT_FAILURE;
+	}
+	if(header->checksum != nvm_checksum(record, size)){
+		return EXIT_FAILURE;
+	}
+
+	memcpy(data, record, size);
+
+	return EXIT_SUCCESS;
+}
+
+
+
+int nvm_write_record(uint32_t sector_address, uint32_t magic, const void *data, uint32_t size){
+
+	/**
+	 * Used to hold the header and record as whole words for programming
+	 */
+	uint32_t buffer[(sizeof(nvm_header_t) + NVM_MAX_RECORD_SIZE + 3) / 4];
+	nvm_header_t *header = (nvm_header_t *)buffer;
+	uint32_t length;
+	uint32_t irq_mask;
+	status_t status;
+
+
+
+	/**
+	 * Validate the record and never touch the firmware image
+	 */
+	if((size > NVM_MAX_RECORD_SIZE) || (sector_address < (uintptr_t)&_image_end) ||
+		((sector_address % NVM_SECTOR_SIZE) != 0) || (sector_address >= NVM_FLASH_END)){
+		return EXIT_FAILURE;
+	}
+
+
+
+	/**
+	 * Initialize the flash driver on first use
+	 */
+	if(!nvm_flash_ready){
+		if(FLASH_Init(&nvm_flash_config) != kStatus_FLASH_Success){
+			return EXIT_FAILURE;
+		}
+#if FLASH_DRIVER_IS_FLASH_RESIDENT
+		if(FLASH_PrepareExecuteInRamFunctions(&nvm_flash_config) != kStatus_FLASH_Success){
+			return EXIT_FAILURE;
+		}
+#endif
+		nvm_flash_ready = true;
+	}
+
+
+
+	/**
+	 * Build the header and record, padded to whole words
+	 */
+	memset(buffer, 0xFF, sizeof(buffer));
+	header->magic = magic;
+	header->size = size;
+	header->checksum = nvm_checksum((const uint8_t *)data, size);
+	memcpy(header + 1, data, size);
+	length = ((sizeof(nvm_header_t) + size + 3) & ~3UL);
+
+
+
+	/**
+	 * Erase and program with interrupts masked
+	 */
+	irq_mask = DisableGlobalIRQ();
+	status = FLASH_Erase(&nvm_flash_config, sector_address, NVM_SECTOR_SIZE, kFLASH_ApiEraseKey);
+	if(status == kStatus_FLASH_Success){
+		status = FLASH_Program(&nvm_flash_config, sector_address, buffer, length);
+	}
+	EnableGlobalIRQ(irq_mask);
+
+	return ((status == kStatus_FLASH_Success) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,88 @@
+/**
+ * @file	nvm.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros and function headers for configuration records kept in flash
+ */
+
+
+
+#ifndef NVM_H_
+#define NVM_H_
+
+
+
+/**
+ * @brief	Size in bytes of a program flash sector, the smallest erasable unit
+ */
+#define NVM_SECTOR_SIZE\
+	(FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE)
+
+
+
+/**
+ * @brief	End of program flash. Configuration records use the sectors just
+ * 			below it, far above the end of the firmware image
+ */
+#define NVM_FLASH_END\
+	(FSL_FEATURE_FLASH_PFLASH_BLOCK_SIZE * FSL_FEATURE_FLASH_PFLASH_BLOCK_COUNT)
+
+
+
+/**
+ * @brief	Sector holding the mounting orientation record
+ */
+#define NVM_ORIENTATION_SECTOR\
+	(NVM_FLASH_END - (1 * NVM_SECTOR_SIZE))
+
+
+
+/**
+ * @brief	Sector holding the LED color calibration record
+ */
+#define NVM_CALIBRATION_SECTOR\
+	(NVM_FLASH_END - (2 * NVM_SECTOR_SIZE))
+
+
+
+/**
+ * @brief	The largest record (excluding its header) that can be stored
+ */
+#define NVM_MAX_RECORD_SIZE\
+	(128)
+
+
+
+/**
+ * @brief	Read a configuration record from flash
+ * @param	sector_address - The flash sector holding the record
+ * @param	magic - The value identifying the kind of record expected
+ * @param	data - Where to copy the record to
+ * @param	size - The size in bytes of the record
+ * @return	EXIT_SUCCESS if a valid record was found, otherwise EXIT_FAILURE
+ * 			and data is left untouched
+ * @detail
+ * 		A record is only valid if its magic, size and checksum all match, so
+ * 		an erased sector or a record left by other firmware is rejected
+ */
+int nvm_read_record(uint32_t sector_address, uint32_t magic, void *data, uint32_t size);
+
+
+
+/**
+ * @brief	Erase a flash sector and write a configuration record to it
+ * @param	sector_address - The flash sector to hold the record
+ * @param	magic - The value identifying the kind of record
+ * @param	data - The record to write
+ * @param	size - The size in bytes of the record
+ * @return	EXIT_SUCCESS or EXIT_FAILURE
+ * @detail
+ * 		Interrupts are masked while the flash controller is busy, since code
+ * 		cannot be fetched from the flash block being written. This blocks for
+ * 		tens of milliseconds, so only call it from configuration workflows
+ */
+int nvm_write_record(uint32_t sector_address, uint32_t magic, const void *data, uint32_t size);
+
+
+
+#endif /* NVM_H_ */
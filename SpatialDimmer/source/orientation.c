@@ -0,0 +1,211 @@
+/**
+ * @file	orientation.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for mounting orientation remapping
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "led.h"		// Keep led.h included before mma8451q.h for led_color_t typedef
+#include "pipeline.h"	// Keep pipeline.h included before mma8451q.h for sample_block_t typedef
+#include "mma8451q.h"
+#include "nvm.h"
+#include "orientation.h"
+
+
+
+/**
+ * @brief	The identity matrix, used until an orientation is saved
+ */
+static const orientation_matrix_t orientation_identity = {
+	.m = {
+		{ORIENTATION_ONE_Q14, 0, 0},
+		{0, ORIENTATION_ONE_Q14, 0},
+		{0, 0, ORIENTATION_ONE_Q14}
+	}
+};
+
+
+
+/**
+ * @brief	The matrix currently applied to every sample
+ */
+static orientation_matrix_t orientation_matrix;
+
+
+
+/**
+ * @brief	Fast path for pure permutations: which board axis feeds each
+ * 			fixture axis and whether it is negated
+ */
+static bool orientation_is_permutation;
+static uint8_t orientation_source[3];
+static bool orientation_negate[3];
+
+
+
+/**
+ * @brief	Clamp a remapped value to the XYZ range. Negating XYZ_MIN or
+ * 			rotating a full-scale vector can otherwise fall just outside it
+ */
+static int16_t orientation_clamp(int32_t value){
+
+	if(value > XYZ_MAX){
+		return XYZ_MAX;
+	}
+	if(value < XYZ_MIN){
+		return XYZ_MIN;
+	}
+
+	return ((int16_t)value);
+}
+
+
+
+void init_orientation(void){
+
+	/**
+	 * Used to hold the orientation read from flash
+	 */
+	orientation_matrix_t saved;
+
+
+
+	/**
+	 * Use the saved orientation if it is valid, otherwise identity
+	 */
+	if((nvm_read_record(NVM_ORIENTATION_SECTOR, ORIENTATION_NVM_MAGIC, &saved, sizeof(saved)) != EXIT_SUCCESS) ||
+		(set_orientation(&saved) != EXIT_SUCCESS)){
+		set_orientation(&orientation_identity);
+	}
+}
+
+
+
+int set_orientation(const orientation_matrix_t *new_matrix){
+
+	/**
+	 * Used to count and locate the non-zero entries of each row
+	 */
+	bool is_permutation = true;
+	uint8_t source[3];
+	bool negate[3];
+	int nonzero;
+
+
+
+	/**
+	 * Validate every entry and work out whether each row picks exactly one
+	 * board axis with a weight of +/-1.0
+	 */
+	for(int r = 0; r < 3; r++){
+		nonzero = 0;
+		source[r] = r;
+		negate[r] = false;
+		for(int c = 0; c < 3; c++){
+			int16_t entry = new_matrix->m[r][c];
+			if((entry > ORIENTATION_ONE_Q14) || (entry < -ORIENTATION_ONE_Q14)){
+				return EXIT_FAILURE;
+			}
+			if(entry != 0){
+				nonzero++;
+				source[r] = c;
+				negate[r] = (entry < 0);
+				if((entry != ORIENTATION_ONE_Q14) && (entry != -ORIENTATION_ONE_Q14)){
+					is_permutation = false;
+				}
+			}
+		}
+		if(nonzero != 1){
+			is_permutation = false;
+		}
+	}
+
+
+
+	/**
+	 * Switch to the new orientation
+	 */
+	orientation_matrix = *new_matrix;
+	for(int r = 0; r < 3; r++){
+		orientation_source[r] = source[r];
+		orientation_negate[r] = negate[r];
+	}
+	orientation_is_permutation = is_permutation;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+int save_orientation(void){
+
+	return (nvm_write_record(NVM_ORIENTATION_SECTOR, ORIENTATION_NVM_MAGIC, &orientation_matrix, sizeof(orientation_matrix)));
+}
+
+
+
+void get_orientation(orientation_matrix_t *matrix){
+
+	*matrix = orientation_matrix;
+}
+
+
+
+void remap_orientation_block(sample_block_t *sample_block){
+
+	/**
+	 * Used to hold the board axes of a sample before they are overwritten
+	 */
+	int32_t board[3];
+	int32_t fixture[3];
+
+
+
+	/**
+	 * Decide on the fast path once for the whole block
+	 */
+	if(orientation_is_permutation){
+		for(int i = 0; i < sample_block->count; i++){
+			board[0] = sample_block->x[i];
+			board[1] = sample_block->y[i];
+			board[2] = sample_block->z[i];
+			for(int r = 0; r < 3; r++){
+				fixture[r] = orientation_negate[r] ? -board[orientation_source[r]] : board[orientation_source[r]];
+			}
+			sample_block->x[i] = orientation_clamp(fixture[0]);
+			sample_block->y[i] = orientation_clamp(fixture[1]);
+			sample_block->z[i] = orientation_clamp(fixture[2]);
+		}
+	}
+	else{
+		for(int i = 0; i < sample_block->count; i++){
+			board[0] = sample_block->x[i];
+			board[1] = sample_block->y[i];
+			board[2] = sample_block->z[i];
+			for(int r = 0; r < 3; r++){
+				fixture[r] = (
+					(orientation_matrix.m[r][0] * board[0]) +
+					(orientation_matrix.m[r][1] * board[1]) +
+					(orientation_matrix.m[r][2] * board[2]) +
+					(ORIENTATION_ONE_Q14 / 2)) >> 14;
+			}
+			sample_block->x[i] = orientation_clamp(fixture[0]);
+			sample_block->y[i] = orientation_clamp(fixture[1]);
+			sample_block->z[i] = orientation_clamp(fixture[2]);
+		}
+	}
+}
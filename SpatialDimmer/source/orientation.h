@@ -0,0 +1,89 @@
+/**
+ * @file	orientation.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros and function headers for mounting orientation remapping
+ */
+
+
+
+#ifndef ORIENTATION_H_
+#define ORIENTATION_H_
+
+
+
+/**
+ * @brief	1.0 in Q14, the format of orientation matrix entries
+ */
+#define ORIENTATION_ONE_Q14\
+	(16384)
+
+
+
+/**
+ * @brief	Identifies an orientation record in flash ("ORNT")
+ */
+#define ORIENTATION_NVM_MAGIC\
+	(0x4F524E54UL)
+
+
+
+/**
+ * @brief	A 3x3 rotation/permutation matrix in Q14, where row r gives the
+ * 			weights of the board x, y and z axes for fixture axis r
+ * @detail
+ * 		Fixture x, y and z drive red, green and blue. The identity matrix keeps
+ * 		the board axes as they are
+ */
+typedef struct orientation_matrix_s{
+	int16_t m[3][3];
+} orientation_matrix_t;
+
+
+
+/**
+ * @brief	Load the mounting orientation from flash, falling back to identity
+ * 			if no valid orientation has been saved
+ */
+void init_orientation(void);
+
+
+
+/**
+ * @brief	Switch to a new mounting orientation
+ * @param	new_matrix - The matrix to apply to every sample
+ * @return	EXIT_SUCCESS or EXIT_FAILURE if an entry is outside +/-1.0
+ * @detail
+ * 		If every row has a single entry of exactly +/-1.0, the matrix is a
+ * 		pure axis permutation with sign flips and samples are remapped with
+ * 		moves and negations only, with no multiplies
+ */
+int set_orientation(const orientation_matrix_t *new_matrix);
+
+
+
+/**
+ * @brief	Save the current mounting orientation to flash
+ * @return	EXIT_SUCCESS or EXIT_FAILURE
+ */
+int save_orientation(void);
+
+
+
+/**
+ * @brief	Read the current mounting orientation
+ * @param	matrix - Where to copy the matrix out to
+ */
+void get_orientation(orientation_matrix_t *matrix);
+
+
+
+/**
+ * @brief	Apply the mounting orientation to every sample of a block in place
+ * @param	sample_block - The block to remap
+ */
+void remap_orientation_block(sample_block_t *sample_block);
+
+
+
+#endif /* ORIENTATION_H_ */
@@ -0,0 +1,278 @@
+/**
+ * @file	pipeline.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for the block-based sample pipeline
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "led.h"		// Keep led.h included before mma8451q.h for led_color_t typedef
+#include "pipeline.h"	// Keep pipeline.h included before mma8451q.h for sample_block_t typedef
+#include "mma8451q.h"
+#include "curve.h"
+#include "fade.h"
+#include "hsv.h"
+#include "motion.h"
+#include "orientation.h"
+#include "sampling.h"
+#include "scene.h"
+#include "tpm.h"
+#include "ws2812.h"
+
+
+
+#if (PIPELINE_FILTER_SHIFT > 0)
+/**
+ * @brief	Filtered value of each axis, scaled up by 2^PIPELINE_FILTER_SHIFT
+ * 			so the filter keeps its fractional bits between blocks
+ */
+static int32_t filtered_x_scaled = 0;
+static int32_t filtered_y_scaled = 0;
+static int32_t filtered_z_scaled = 0;
+
+
+
+/**
+ * @brief	Used to seed the filter with the first sample
+ */
+static bool filter_seeded = false;
+#endif
+
+
+
+/**
+ * @brief	The blocks flowing through the pipeline. Kept static so the
+ * 			pipeline never needs stack space for them
+ * @detail
+ * 		The sample task fills one sample block while the other waits for the
+ * 		filter and render tasks
+ */
+static sample_block_t pipeline_sample_blocks[2];
+static rgb_block_t pipeline_rgb_block;
+
+
+
+/**
+ * @brief	The sample block being filled, the full block waiting to be
+ * 			processed (NULL if none), and whether it has been filtered
+ */
+static uint8_t pipeline_filling = 0;
+static sample_block_t *pipeline_full_block = NULL;
+static bool pipeline_block_filtered = false;
+
+
+
+void filter_sample_block(sample_block_t *sample_block){
+
+#if (PIPELINE_FILTER_SHIFT > 0)
+
+	/**
+	 * Seed with the first sample so the output does not ramp up from 0
+	 */
+	if(!filter_seeded && (sample_block->count > 0)){
+		filtered_x_scaled = ((int32_t)sample_block->x[0] << PIPELINE_FILTER_SHIFT);
+		filtered_y_scaled = ((int32_t)sample_block->y[0] << PIPELINE_FILTER_SHIFT);
+		filtered_z_scaled = ((int32_t)sample_block->z[0] << PIPELINE_FILTER_SHIFT);
+		filter_seeded = true;
+	}
+
+
+
+	/**
+	 * Smooth each axis in its own tight loop
+	 */
+	for(int i = 0; i < sample_block->count; i++){
+		filtered_x_scaled += sample_block->x[i] - (filtered_x_scaled >> PIPELINE_FILTER_SHIFT);
+		sample_block->x[i] = (int16_t)(filtered_x_scaled >> PIPELINE_FILTER_SHIFT);
+	}
+	for(int i = 0; i < sample_block->count; i++){
+		filtered_y_scaled += sample_block->y[i] - (filtered_y_scaled >> PIPELINE_FILTER_SHIFT);
+		sample_block->y[i] = (int16_t)(filtered_y_scaled >> PIPELINE_FILTER_SHIFT);
+	}
+	for(int i = 0; i < sample_block->count; i++){
+		filtered_z_scaled += sample_block->z[i] - (filtered_z_scaled >> PIPELINE_FILTER_SHIFT);
+		sample_block->z[i] = (int16_t)(filtered_z_scaled >> PIPELINE_FILTER_SHIFT);
+	}
+#else
+	(void)sample_block;
+#endif
+}
+
+
+
+void map_sample_block(const sample_block_t *sample_block, rgb_block_t *rgb_block){
+
+	/**
+	 * Dispatch on the mapping mode once per block rather than per sample
+	 */
+	switch(mapping_mode){
+	case mapping_motion:
+		calculate_rgb_block_from_motion(sample_block, rgb_block);
+		break;
+	case mapping_curve:
+		calculate_rgb_block_from_curve(sample_block, rgb_block);
+		break;
+	case mapping_hsv:
+		calculate_rgb_block_from_hsv(sample_block, rgb_block);
+		break;
+	case mapping_axis:
+	default:
+		calculate_rgb_block_from_xyz(sample_block, rgb_block);
+		break;
+	}
+}
+
+
+
+void output_rgb_block(const rgb_block_t *rgb_block){
+
+	/**
+	 * Used to hold the index of the newest RGB levels
+	 */
+	int newest;
+
+
+
+	/**
+	 * Only the newest levels are visible, so output those
+	 */
+	if(rgb_block->count == 0){
+		return;
+	}
+	newest = (rgb_block->count - 1);
+
+
+
+	/**
+	 * A playing scene owns the LEDs and blends these levels in itself. A
+	 * fade owns them until it ends
+	 */
+	if(scene_active){
+		set_scene_input(rgb_block->red[newest], rgb_block->green[newest], rgb_block->blue[newest]);
+	}
+	else if(!fade_active){
+		publish_rgb_levels(rgb_block->red[newest], rgb_block->green[newest], rgb_block->blue[newest]);
+	}
+
+
+
+	/**
+	 * Mirror the on-board color onto the strip once the last frame is out
+	 */
+	if(!ws2812_busy){
+		fill_ws2812_pixels(current_red_level, current_green_level, current_blue_level);
+		show_ws2812_pixels();
+	}
+}
+
+
+
+/**
+ * @brief	Hand the block being filled on once it is full, and start filling
+ * 			the other, unless the other is still being processed, in which
+ * 			case the full block waits
+ * @return	true if a block was handed on
+ */
+static bool pipeline_hand_on_block(void){
+
+	if((pipeline_sample_blocks[pipeline_filling].count < SAMPLE_BLOCK_SIZE) || (pipeline_full_block != NULL)){
+		return false;
+	}
+	pipeline_full_block = &pipeline_sample_blocks[pipeline_filling];
+	pipeline_filling ^= 1;
+	pipeline_sample_blocks[pipeline_filling].count = 0;
+
+	return true;
+}
+
+
+
+void run_sample_task(void){
+
+	/**
+	 * Used to hold each sample, the block it goes into and whether any came
+	 */
+	timed_sample_t sample;
+	sample_block_t *sample_block;
+	bool received = false;
+
+
+
+	/**
+	 * Move the samples into blocks as long as there is room, handing each
+	 * block on as it fills
+	 */
+	do{
+		sample_block = &pipeline_sample_blocks[pipeline_filling];
+		while((sample_block->count < SAMPLE_BLOCK_SIZE) && pop_timed_sample(&sample)){
+			sample_block->timestamp[sample_block->count] = sample.timestamp;
+			sample_block->x[sample_block->count] = sample.x;
+			sample_block->y[sample_block->count] = sample.y;
+			sample_block->z[sample_block->count] = sample.z;
+			sample_block->count++;
+			received = true;
+		}
+	} while(pipeline_hand_on_block());
+
+
+
+	/**
+	 * A whole tick without a sample may mean INT1 was missed
+	 */
+	if(!received){
+		poll_sampling();
+	}
+}
+
+
+
+void run_filter_task(void){
+
+	/**
+	 * Remap to fixture axes and filter a full block once
+	 */
+	if((pipeline_full_block == NULL) || pipeline_block_filtered){
+		return;
+	}
+	remap_orientation_block(pipeline_full_block);
+	filter_sample_block(pipeline_full_block);
+	pipeline_block_filtered = true;
+}
+
+
+
+void run_render_task(void){
+
+	/**
+	 * Map and output a filtered block
+	 */
+	if((pipeline_full_block == NULL) || !pipeline_block_filtered){
+		return;
+	}
+	map_sample_block(pipeline_full_block, &pipeline_rgb_block);
+	output_rgb_block(&pipeline_rgb_block);
+
+
+
+	/**
+	 * Leave the newest sample in the current XYZ values for printing, and
+	 * hand the block back to the sample task
+	 */
+	current_x = pipeline_full_block->x[pipeline_full_block->count - 1];
+	current_y = pipeline_full_block->y[pipeline_full_block->count - 1];
+	current_z = pipeline_full_block->z[pipeline_full_block->count - 1];
+	pipeline_block_filtered = false;
+	pipeline_full_block = NULL;
+}
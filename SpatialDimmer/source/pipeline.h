@@ -0,0 +1,120 @@
+/**
+ * @file	pipeline.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros, types and function headers for the block-based sample pipeline
+ */
+
+
+
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+
+
+/**
+ * @brief	The amount of samples carried through the pipeline at once. At
+ * 			800 Hz ODR a block of 8 samples covers 10 ms
+ */
+#define SAMPLE_BLOCK_SIZE\
+	(8)
+
+
+
+/**
+ * @brief	Amount of smoothing applied by the filter stage. Each sample moves
+ * 			the filtered value 1/2^PIPELINE_FILTER_SHIFT of the way towards it,
+ * 			where 0 passes samples through untouched
+ */
+#define PIPELINE_FILTER_SHIFT\
+	(0)
+
+
+
+/**
+ * @brief	A block of XYZ samples stored as a structure of arrays, so each
+ * 			stage walks one axis at a time in a tight loop
+ * @detail
+ * 		timestamp holds when each sample was acquired, in us from the
+ * 		timebase (see timebase.h), so stages can see jitter and dropped
+ * 		samples from the gaps between them
+ */
+typedef struct sample_block_s{
+	uint16_t count;
+	int16_t x[SAMPLE_BLOCK_SIZE];
+	int16_t y[SAMPLE_BLOCK_SIZE];
+	int16_t z[SAMPLE_BLOCK_SIZE];
+	uint64_t timestamp[SAMPLE_BLOCK_SIZE];
+} sample_block_t;
+
+
+
+/**
+ * @brief	A block of RGB levels, one per sample of the sample block it was
+ * 			mapped from
+ */
+typedef struct rgb_block_s{
+	uint16_t count;
+	int16_t red[SAMPLE_BLOCK_SIZE];
+	int16_t green[SAMPLE_BLOCK_SIZE];
+	int16_t blue[SAMPLE_BLOCK_SIZE];
+} rgb_block_t;
+
+
+
+/**
+ * @brief	Filter stage: smooth each axis of a sample block in place
+ * @param	sample_block - The block to filter
+ */
+void filter_sample_block(sample_block_t *sample_block);
+
+
+
+/**
+ * @brief	Map stage: map a sample block to an RGB block according to
+ * 			mapping_mode
+ * @param	sample_block - The block to map from
+ * @param	rgb_block - The block to map to
+ */
+void map_sample_block(const sample_block_t *sample_block, rgb_block_t *rgb_block);
+
+
+
+/**
+ * @brief	Output stage: drive the on-board LEDs with the newest RGB levels
+ * 			of a block
+ * @param	rgb_block - The block to output
+ */
+void output_rgb_block(const rgb_block_t *rgb_block);
+
+
+
+/**
+ * @brief	Sample task: move the samples acquired since the last run into
+ * 			blocks (see sampling.h), and hand each block on once it is full
+ * @detail
+ * 		Acquisition itself happens in the urgent trigger interrupts, so the
+ * 		samples keep their spacing however late this runs
+ */
+void run_sample_task(void);
+
+
+
+/**
+ * @brief	Filter task: remap a full block to fixture axes and filter it
+ */
+void run_filter_task(void);
+
+
+
+/**
+ * @brief	Render task: map a filtered block to RGB levels and output them
+ * @detail
+ * 		The newest sample is also left in current_x/y/z, and the newest RGB
+ * 		levels in current_red/green/blue_level, for printing
+ */
+void run_render_task(void);
+
+
+
+#endif /* PIPELINE_H_ */
@@ -0,0 +1,103 @@
+/**
+ * @file	queue.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for the single-producer single-consumer ring
+ * 			buffer
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "queue.h"
+
+
+
+bool push_queue(queue_t *queue, const void *item){
+
+	/**
+	 * Used to hold the producer's own index
+	 */
+	uint16_t head = queue->head;
+
+
+
+	/**
+	 * The consumer frees slots by advancing tail, so reading it here can
+	 * only under-estimate the free space
+	 */
+	if((uint16_t)(head - queue->tail) >= queue->capacity){
+		return false;
+	}
+
+
+
+	/**
+	 * Copy the item in, then publish it. The barrier keeps the copy from
+	 * being reordered past the store to head
+	 */
+	memcpy(&queue->items[(uint32_t)(head & (queue->capacity - 1)) * queue->item_size], item, queue->item_size);
+	__DMB();
+	queue->head = head + 1;
+
+	return true;
+}
+
+
+
+bool pop_queue(queue_t *queue, void *item){
+
+	/**
+	 * Used to hold the consumer's own index
+	 */
+	uint16_t tail = queue->tail;
+
+
+
+	/**
+	 * The producer only ever adds items, so an item seen here stays put
+	 * until tail is advanced past it
+	 */
+	if(queue->head == tail){
+		return false;
+	}
+
+
+
+	/**
+	 * Copy the item out, then free its slot. The first barrier keeps the
+	 * copy from reading ahead of the head it was published by, the second
+	 * keeps it from being reordered past the store to tail
+	 */
+	__DMB();
+	memcpy(item, &queue->items[(uint32_t)(tail & (queue->capacity - 1)) * queue->item_size], queue->item_size);
+	__DMB();
+	queue->tail = tail + 1;
+
+	return true;
+}
+
+
+
+void flush_queue(queue_t *queue){
+
+	queue->tail = queue->head;
+}
+
+
+
+uint16_t get_queue_count(const queue_t *queue){
+
+	return (uint16_t)(queue->head - queue->tail);
+}
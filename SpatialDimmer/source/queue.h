@@ -0,0 +1,78 @@
+/**
+ * @file	queue.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Types and function headers for the single-producer single-consumer
+ * 			ring buffer
+ */
+
+
+
+#ifndef QUEUE_H_
+#define QUEUE_H_
+
+
+
+/**
+ * @brief	A ring buffer of fixed-size items passed from one producer to one
+ * 			consumer, typically an interrupt to the main loop
+ * @detail
+ * 		items:		Storage for capacity items of item_size bytes each
+ * 		item_size:	The size of one item in bytes
+ * 		capacity:	How many items fit. Must be a power of two
+ * 		head:		Items pushed so far, written only by the producer
+ * 		tail:		Items popped so far, written only by the consumer
+ *
+ * 		The Cortex-M0+ has no exclusive load/store, so nothing is locked:
+ * 		each index has a single writer, and a barrier orders the item copy
+ * 		before the index publishing it. head and tail run freely and wrap,
+ * 		so head - tail is the count even when the queue is full
+ */
+typedef struct queue_s{
+	uint8_t *items;
+	uint16_t item_size;
+	uint16_t capacity;
+	volatile uint16_t head;
+	volatile uint16_t tail;
+} queue_t;
+
+
+
+/**
+ * @brief	Producer: copy an item into the queue
+ * @param	queue - The queue to push to
+ * @param	item - The item to copy in
+ * @return	true if the item was queued, or false if the queue was full
+ */
+bool push_queue(queue_t *queue, const void *item);
+
+
+
+/**
+ * @brief	Consumer: copy the oldest item out of the queue
+ * @param	queue - The queue to pop from
+ * @param	item - Where to copy the item out to
+ * @return	true if an item was popped, or false if the queue was empty
+ */
+bool pop_queue(queue_t *queue, void *item);
+
+
+
+/**
+ * @brief	Consumer: discard every item queued so far
+ * @param	queue - The queue to flush
+ */
+void flush_queue(queue_t *queue);
+
+
+
+/**
+ * @brief	Count the items waiting in a queue
+ * @param	queue - The queue to count
+ * @return	The amount of items pushed but not yet popped
+ */
+uint16_t get_queue_count(const queue_t *queue);
+
+
+
+#endif /* QUEUE_H_ */
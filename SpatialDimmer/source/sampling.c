@@ -0,0 +1,378 @@
+/**
+ * @file	sampling.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for sample acquisition and sample timing
+ * 			statistics
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "led.h"		// Keep led.h included before mma8451q.h for led_color_t typedef
+#include "pipeline.h"	// Keep pipeline.h included before mma8451q.h for sample_block_t typedef
+#include "mma8451q.h"
+#include "lptmr.h"
+#include "motion.h"
+#include "queue.h"
+#include "timebase.h"
+#include "tpm.h"
+#include "sampling.h"
+
+
+
+/**
+ * @brief	The largest gap deviation accumulated, which keeps each square
+ * 			within 32 bits
+ */
+#define SAMPLING_DEVIATION_LIMIT_US\
+	(65535)
+
+
+
+/**
+ * @brief	Whether the LPTMR is acquiring samples
+ */
+volatile bool timed_sampling_active = false;
+
+
+
+/**
+ * @brief	Whether samples are being acquired at all, timed or on INT1
+ */
+volatile bool sampling_active = false;
+
+
+
+/**
+ * @brief	Whether the accelerometer is slowed to SAMPLING_REST_HZ
+ */
+volatile bool sampling_resting = false;
+
+
+
+/**
+ * @brief	Where the fixture last settled, and since when
+ */
+static int16_t sampling_still_x = 0;
+static int16_t sampling_still_y = 0;
+static int16_t sampling_still_z = 0;
+static uint64_t sampling_still_since = 0;
+
+
+
+/**
+ * @brief	The samples acquired by the trigger interrupts and not yet taken
+ */
+static timed_sample_t sampling_items[SAMPLING_QUEUE_SIZE];
+static queue_t sampling_queue = {
+	.items = (uint8_t *)sampling_items,
+	.item_size = sizeof(timed_sample_t),
+	.capacity = SAMPLING_QUEUE_SIZE
+};
+
+
+
+/**
+ * @brief	The running timing statistics:
+ * 	- When the last acquisition started, once there has been one
+ * 	- Sum of each gap's deviation from the period, and of its square
+ * 	- The largest deviation, and the samples dropped
+ */
+static bool sampling_seeded = false;
+static uint64_t sampling_last = 0;
+static uint32_t sampling_intervals = 0;
+static int64_t sampling_deviation_sum = 0;
+static uint64_t sampling_deviation_squares = 0;
+static uint32_t sampling_max_deviation = 0;
+static uint32_t sampling_dropped = 0;
+
+
+
+/**
+ * @brief	Note when an acquisition started, for the timing statistics
+ * @param	timestamp - When the acquisition started, from the timebase
+ */
+static void record_sample_time(uint64_t timestamp){
+
+	/**
+	 * Used to hold the gap since the last acquisition and its distance from
+	 * the period
+	 */
+	uint32_t interval;
+	int32_t deviation;
+	uint32_t magnitude;
+
+
+
+	/**
+	 * The first acquisition only starts the first gap
+	 */
+	if(!sampling_seeded){
+		sampling_seeded = true;
+		sampling_last = timestamp;
+		return;
+	}
+	interval = (uint32_t)(timestamp - sampling_last);
+	sampling_last = timestamp;
+
+
+
+	/**
+	 * Accumulate the deviation and its square, limited so a long stall
+	 * cannot overflow the sum of squares
+	 */
+	deviation = (int32_t)interval - (int32_t)get_sampling_period_us();
+	magnitude = (deviation < 0) ? (uint32_t)-deviation : (uint32_t)deviation;
+	if(magnitude > SAMPLING_DEVIATION_LIMIT_US){
+		magnitude = SAMPLING_DEVIATION_LIMIT_US;
+		deviation = (deviation < 0) ? -SAMPLING_DEVIATION_LIMIT_US : SAMPLING_DEVIATION_LIMIT_US;
+	}
+	sampling_intervals++;
+	sampling_deviation_sum += deviation;
+	sampling_deviation_squares += magnitude * magnitude;
+	if(magnitude > sampling_max_deviation){
+		sampling_max_deviation = magnitude;
+	}
+}
+
+
+
+/**
+ * @brief	Slow the accelerometer down while the LEDs are dark and the fixture
+ * 			is still, and speed it back up when either changes
+ * @param	sample - The sample just acquired
+ * @detail
+ * 		Runs in the trigger interrupt, which owns the I2C bus. Each switch
+ * 		restarts the timing statistics, which hold for one period only
+ */
+static void sampling_update_rest(const timed_sample_t *sample){
+
+	/**
+	 * Used to hold whether every level is off and whether the fixture moved
+	 */
+	bool dark = (current_red_level == 0) && (current_green_level == 0) && (current_blue_level == 0);
+	bool moved =
+		(abs(sample->x - sampling_still_x) > SAMPLING_STILL_COUNTS) ||
+		(abs(sample->y - sampling_still_y) > SAMPLING_STILL_COUNTS) ||
+		(abs(sample->z - sampling_still_z) > SAMPLING_STILL_COUNTS);
+
+
+
+	/**
+	 * Settle again wherever the fixture moved to
+	 */
+	if(moved){
+		sampling_still_x = sample->x;
+		sampling_still_y = sample->y;
+		sampling_still_z = sample->z;
+		sampling_still_since = sample->timestamp;
+	}
+
+
+
+	/**
+	 * Timed sampling reads at SAMPLING_HZ whatever the accelerometer does,
+	 * so it never rests
+	 */
+	if(sampling_resting){
+		if(moved || !dark || timed_sampling_active){
+			set_onboard_accelerometer_rate(accelerometer_800hz);
+			sampling_resting = false;
+			reset_sampling_jitter();
+		}
+	}
+	else if(dark && !timed_sampling_active && ((sample->timestamp - sampling_still_since) >= (SAMPLING_REST_AFTER_MS * (TIMEBASE_HZ / 1000)))){
+		set_onboard_accelerometer_rate(accelerometer_50hz);
+		sampling_resting = true;
+		reset_sampling_jitter();
+	}
+}
+
+
+
+/**
+ * @brief	Called from the acquisition trigger, the LPTMR or INT1 interrupt:
+ * 			note when, read a sample over I2C and queue it
+ * @detail
+ * 		Both triggers run at DEFERRED_URGENT_PRIORITY, so neither PendSV nor
+ * 		the main loop can delay the timestamp or the read. On INT1 the
+ * 		sample is only read if one is ready, since poll_sampling() also
+ * 		pends the interrupt
+ */
+static void sampling_acquire(void){
+
+	/**
+	 * Used to hold the sample being acquired
+	 */
+	timed_sample_t sample;
+
+	sample.timestamp = get_timebase_us();
+	if(!timed_sampling_active && !is_onboard_accelerometer_ready()){
+		return;
+	}
+	read_onboard_accelerometer_sample(&sample.x, &sample.y, &sample.z);
+	record_sample_time(sample.timestamp);
+	if(!push_queue(&sampling_queue, &sample)){
+		sampling_dropped++;
+	}
+	sampling_update_rest(&sample);
+}
+
+
+
+void start_sampling(void){
+
+	set_onboard_accelerometer_handler(sampling_acquire);
+	sampling_active = true;
+#if SAMPLING_TIMED
+	if(start_timed_sampling() == EXIT_SUCCESS){
+		return;
+	}
+#endif
+	enable_onboard_accelerometer_interrupt(true);
+}
+
+
+
+int start_timed_sampling(void){
+
+	if(timed_sampling_active){
+		return EXIT_SUCCESS;
+	}
+
+
+
+	/**
+	 * Take over from INT1, and start from an empty queue and fresh
+	 * statistics. INT1 is handed back if the LPTMR cannot pace samples
+	 */
+	enable_onboard_accelerometer_interrupt(false);
+	flush_queue(&sampling_queue);
+	reset_sampling_jitter();
+	timed_sampling_active = true;
+	if(start_lptmr_periodic(SAMPLING_HZ, sampling_acquire) != EXIT_SUCCESS){
+		timed_sampling_active = false;
+		enable_onboard_accelerometer_interrupt(true);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+
+void stop_timed_sampling(void){
+
+	if(!timed_sampling_active){
+		return;
+	}
+	stop_lptmr_periodic();
+	timed_sampling_active = false;
+	reset_sampling_jitter();
+	enable_onboard_accelerometer_interrupt(true);
+}
+
+
+
+uint32_t get_sampling_period_us(void){
+
+	return sampling_resting ? SAMPLING_REST_PERIOD_US : SAMPLING_PERIOD_US;
+}
+
+
+
+bool pop_timed_sample(timed_sample_t *sample){
+
+	return pop_queue(&sampling_queue, sample);
+}
+
+
+
+void poll_sampling(void){
+
+	if(!timed_sampling_active){
+		pend_onboard_accelerometer_interrupt();
+	}
+}
+
+
+
+void get_sampling_jitter(sampling_jitter_t *jitter){
+
+	/**
+	 * Used to hold a consistent copy of the running statistics
+	 */
+	uint32_t irq_mask;
+	uint32_t intervals;
+	int64_t deviation_sum;
+	uint64_t deviation_squares;
+	int64_t mean;
+	int64_t variance;
+
+
+
+	/**
+	 * The trigger interrupts may be updating them
+	 */
+	irq_mask = DisableGlobalIRQ();
+	intervals = sampling_intervals;
+	deviation_sum = sampling_deviation_sum;
+	deviation_squares = sampling_deviation_squares;
+	jitter->max_deviation_us = sampling_max_deviation;
+	jitter->dropped = sampling_dropped;
+	EnableGlobalIRQ(irq_mask);
+
+
+
+	/**
+	 * Variance is the mean square less the squared mean. Rounding can take
+	 * it just below 0
+	 */
+	jitter->intervals = intervals;
+	if(intervals == 0){
+		jitter->mean_deviation_us = 0;
+		jitter->stddev_us = 0;
+		return;
+	}
+	mean = deviation_sum / intervals;
+	variance = (int64_t)(deviation_squares / intervals) - (mean * mean);
+	if(variance < 0){
+		variance = 0;
+	}
+	if(variance > UINT32_MAX){
+		variance = UINT32_MAX;
+	}
+	jitter->mean_deviation_us = (int32_t)mean;
+	jitter->stddev_us = integer_sqrt((uint32_t)variance);
+}
+
+
+
+void reset_sampling_jitter(void){
+
+	/**
+	 * Used to clear the statistics without a trigger interrupt in between
+	 */
+	uint32_t irq_mask;
+
+	irq_mask = DisableGlobalIRQ();
+	sampling_seeded = false;
+	sampling_intervals = 0;
+	sampling_deviation_sum = 0;
+	sampling_deviation_squares = 0;
+	sampling_max_deviation = 0;
+	sampling_dropped = 0;
+	EnableGlobalIRQ(irq_mask);
+}
@@ -0,0 +1,230 @@
+/**
+ * @file	sampling.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros, types and function headers for sample acquisition and
+ * 			sample timing statistics
+ */
+
+
+
+#ifndef SAMPLING_H_
+#define SAMPLING_H_
+
+
+
+/**
+ * @brief	Set to 1 to acquire samples on the LPTMR at SAMPLING_HZ instead of
+ * 			on accelerometer INT1
+ */
+#define SAMPLING_TIMED\
+	(0)
+
+
+
+/**
+ * @brief	The acquisition rate in Hz, matching the 800 Hz output data rate
+ */
+#define SAMPLING_HZ\
+	(800)
+
+
+
+/**
+ * @brief	The nominal time between acquisitions in us
+ */
+#define SAMPLING_PERIOD_US\
+	(TIMEBASE_HZ / SAMPLING_HZ)
+
+
+
+/**
+ * @brief	The acquisition rate in Hz while resting, matching the 50 Hz output
+ * 			data rate set then, which leaves idle time to sleep in VLPS
+ * 			between samples
+ */
+#define SAMPLING_REST_HZ\
+	(50)
+
+
+
+/**
+ * @brief	The nominal time between acquisitions in us while resting
+ */
+#define SAMPLING_REST_PERIOD_US\
+	(TIMEBASE_HZ / SAMPLING_REST_HZ)
+
+
+
+/**
+ * @brief	How far in counts any axis may stray from where it settled and
+ * 			still count as still. 64 is about 16 mg, above the 800 Hz noise
+ */
+#define SAMPLING_STILL_COUNTS\
+	(64)
+
+
+
+/**
+ * @brief	How long in ms the LEDs must be dark and the fixture still before
+ * 			resting
+ */
+#define SAMPLING_REST_AFTER_MS\
+	(2000)
+
+
+
+/**
+ * @brief	How many samples can wait for the sample task. Must be a power of
+ * 			two. 64 covers 80 ms at 800 Hz, longer than telemetry holds the
+ * 			main loop up
+ */
+#define SAMPLING_QUEUE_SIZE\
+	(64)
+
+
+
+/**
+ * @brief	One XYZ sample and when its acquisition started
+ */
+typedef struct timed_sample_s{
+	uint64_t timestamp;
+	int16_t x;
+	int16_t y;
+	int16_t z;
+} timed_sample_t;
+
+
+
+/**
+ * @brief	Timing statistics of the acquisitions since the last reset
+ * @detail
+ * 		intervals:			How many gaps between acquisitions were measured
+ * 		mean_deviation_us:	The average gap minus the sample period
+ * 		stddev_us:			The standard deviation of the gaps
+ * 		max_deviation_us:	The largest distance of a gap from the sample
+ * 							period
+ * 		dropped:			Samples lost because the queue was full
+ */
+typedef struct sampling_jitter_s{
+	uint32_t intervals;
+	int32_t mean_deviation_us;
+	uint32_t stddev_us;
+	uint32_t max_deviation_us;
+	uint32_t dropped;
+} sampling_jitter_t;
+
+
+
+/**
+ * @brief	Defined in sampling.c
+ */
+extern volatile bool timed_sampling_active;
+
+
+
+/**
+ * @brief	Defined in sampling.c
+ */
+extern volatile bool sampling_active;
+
+
+
+/**
+ * @brief	Defined in sampling.c
+ */
+extern volatile bool sampling_resting;
+
+
+
+/**
+ * @brief	Start acquiring samples, on the LPTMR if SAMPLING_TIMED is set and
+ * 			it can be clocked at SAMPLING_HZ, otherwise on INT1
+ * @detail
+ * 		Either way the trigger is an urgent interrupt (see deferred.h) that
+ * 		notes when, reads the sample over I2C and queues it for
+ * 		run_sample_task(), so acquisitions are never held up by PendSV or
+ * 		the main loop. From here on the I2C bus belongs to the trigger
+ * 		interrupts.
+ *
+ * 		On INT1, once every level has been 0 and no axis has moved more than
+ * 		SAMPLING_STILL_COUNTS for SAMPLING_REST_AFTER_MS, the trigger slows
+ * 		the accelerometer to SAMPLING_REST_HZ so idle can sleep in VLPS
+ * 		between samples. The first sample that moves, a level that lights or timed
+ * 		sampling brings it back to SAMPLING_HZ. Motion filtering is tuned
+ * 		for SAMPLING_HZ, so it settles slower meanwhile
+ */
+void start_sampling(void);
+
+
+
+/**
+ * @brief	Switch to acquiring a sample every 1 / SAMPLING_HZ
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if the LPTMR is in use or cannot
+ * 			be clocked at SAMPLING_HZ, in which case INT1 carries on
+ * @detail
+ * 		Both PIT channels make up the timebase, so the LPTMR paces the
+ * 		acquisitions, clocked from the 8 MHz crystal the PLL is also locked
+ * 		to. The INT1 interrupt is turned off meanwhile, and idle cannot
+ * 		time VLPS.
+ *
+ * 		The accelerometer keeps its own output data rate, so a sample is
+ * 		occasionally read twice or skipped as the two clocks drift
+ */
+int start_timed_sampling(void);
+
+
+
+/**
+ * @brief	Stop timed sampling and return to INT1
+ */
+void stop_timed_sampling(void);
+
+
+
+/**
+ * @brief	Get the nominal time between acquisitions
+ * @return	SAMPLING_REST_PERIOD_US while resting, otherwise
+ * 			SAMPLING_PERIOD_US
+ */
+uint32_t get_sampling_period_us(void);
+
+
+
+/**
+ * @brief	Take the oldest sample acquired
+ * @param	sample - Where to copy the sample out to
+ * @return	true if a sample was taken, or false if none are waiting
+ */
+bool pop_timed_sample(timed_sample_t *sample);
+
+
+
+/**
+ * @brief	Check for a sample INT1 did not report
+ * @detail
+ * 		INT1 stays low until its sample is read, so a missed edge would stop
+ * 		acquisitions for good. Call this when no sample has arrived for a
+ * 		while: it pends the INT1 interrupt, which only reads if a sample is
+ * 		ready and so releases INT1 again
+ */
+void poll_sampling(void);
+
+
+
+/**
+ * @brief	Read the timing statistics
+ * @param	jitter - Where to copy the statistics out to
+ */
+void get_sampling_jitter(sampling_jitter_t *jitter);
+
+
+
+/**
+ * @brief	Restart the timing statistics from the next acquisition
+ */
+void reset_sampling_jitter(void);
+
+
+
+#endif /* SAMPLING_H_ */
@@ -0,0 +1,358 @@
+/**
+ * @file	scene.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for keyframe LED scenes
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "deferred.h"
+#include "led.h"		// Keep led.h included before fade.h for led_color_t typedef
+#include "fade.h"
+#include "scene.h"
+#include "tpm.h"
+
+
+
+/**
+ * @brief	The amount of PWM periods between scene updates
+ */
+#define SCENE_UPDATE_PERIODS\
+	((TPM_PWM_HZ >= (2 * SCENE_UPDATE_HZ)) ? (TPM_PWM_HZ / SCENE_UPDATE_HZ) : 1)
+
+
+
+/**
+ * @brief	The time between scene updates in ms, scaled up by 2^8
+ */
+#define SCENE_UPDATE_MS_Q8\
+	((SCENE_UPDATE_PERIODS * 1000 * 256) / TPM_PWM_HZ)
+
+
+
+/**
+ * @brief	Dividend giving the progress per ms Q8 of a keyframe, such that
+ * 			(elapsed * rate) >> 16 is Q15 progress
+ */
+#define SCENE_RATE_DIVIDEND\
+	(1UL << 23)
+
+
+
+/**
+ * @brief	Set while a scene drives the LEDs
+ */
+volatile bool scene_active = false;
+
+
+
+/**
+ * @brief	Breathe white in and out every 4 seconds
+ */
+static const scene_keyframe_t scene_breathing_keyframes[] = {
+	{1600, RGB_MIN, RGB_MIN, RGB_MIN, fade_ease_in_out},
+	{2400, RGB_MAX, RGB_MAX, RGB_MAX, fade_ease_in_out}
+};
+const scene_t scene_breathing = {
+	.keyframes = scene_breathing_keyframes,
+	.count = 2,
+	.loop = true
+};
+
+
+
+/**
+ * @brief	Cycle through red, green and blue every 6 seconds
+ */
+static const scene_keyframe_t scene_color_cycle_keyframes[] = {
+	{2000, RGB_MAX, RGB_MIN, RGB_MIN, fade_linear},
+	{2000, RGB_MIN, RGB_MAX, RGB_MIN, fade_linear},
+	{2000, RGB_MIN, RGB_MIN, RGB_MAX, fade_linear}
+};
+const scene_t scene_color_cycle = {
+	.keyframes = scene_color_cycle_keyframes,
+	.count = 3,
+	.loop = true
+};
+
+
+
+/**
+ * @brief	Flash red three times, then end
+ */
+static const scene_keyframe_t scene_alert_keyframes[] = {
+	{0, RGB_MAX, RGB_MIN, RGB_MIN, fade_linear},
+	{150, RGB_MIN, RGB_MIN, RGB_MIN, fade_ease_in},
+	{100, RGB_MAX, RGB_MIN, RGB_MIN, fade_ease_out},
+	{150, RGB_MIN, RGB_MIN, RGB_MIN, fade_ease_in},
+	{100, RGB_MAX, RGB_MIN, RGB_MIN, fade_ease_out},
+	{150, RGB_MIN, RGB_MIN, RGB_MIN, fade_ease_in}
+};
+const scene_t scene_alert = {
+	.keyframes = scene_alert_keyframes,
+	.count = 6,
+	.loop = false
+};
+
+
+
+/**
+ * @brief	The scene playing and how it is blended with the tilt color
+ */
+static const scene_t *scene_playing = NULL;
+static scene_blend_t scene_blend_mode = scene_blend_none;
+static uint16_t scene_blend_weight = 0;
+
+
+
+/**
+ * @brief	Playback position: the keyframe being moved to, the time since
+ * 			leaving the previous one in ms Q8, and the progress per ms Q8
+ */
+static uint8_t scene_keyframe = 0;
+static uint32_t scene_elapsed_q8 = 0;
+static uint32_t scene_rate = 0;
+static uint8_t scene_periods = 0;
+
+
+
+/**
+ * @brief	The levels the scene is moving from
+ */
+static int16_t scene_from[3];
+
+
+
+/**
+ * @brief	The newest levels mapped from the accelerometer
+ */
+static volatile int16_t scene_input[3];
+
+
+
+/**
+ * @brief	Start moving towards a keyframe from the levels in scene_from
+ * @param	keyframe - The index of the keyframe to move to
+ * @detail
+ * 		Holds the only divide of playback, once per keyframe
+ */
+static void scene_enter_keyframe(uint8_t keyframe){
+
+	/**
+	 * Used to hold the time taken to reach the keyframe
+	 */
+	uint16_t time_ms = scene_playing->keyframes[keyframe].time_ms;
+
+	scene_keyframe = keyframe;
+	scene_elapsed_q8 = 0;
+	scene_rate = (time_ms == 0) ? 0 : (SCENE_RATE_DIVIDEND / time_ms);
+}
+
+
+
+/**
+ * @brief	Clamp an RGB level to between RGB_MIN and RGB_MAX
+ */
+static inline int16_t scene_clamp(int16_t level){
+
+	if(level < RGB_MIN){
+		return RGB_MIN;
+	}
+	if(level > RGB_MAX){
+		return RGB_MAX;
+	}
+
+	return (level);
+}
+
+
+
+/**
+ * @brief	Mix a scene level with a tilt level
+ * @param	scene_level - The level from the scene
+ * @param	tilt_level - The level from the accelerometer
+ * @return	The blended level
+ */
+static inline int16_t scene_blend(int16_t scene_level, int16_t tilt_level){
+
+	switch(scene_blend_mode){
+	case scene_blend_mix:
+		return ((int16_t)(tilt_level + (((int32_t)(scene_level - tilt_level) * scene_blend_weight) >> 8)));
+	case scene_blend_multiply:
+		return ((int16_t)(((int32_t)tilt_level * (scene_level + 1)) >> 8));
+	case scene_blend_none:
+	default:
+		return (scene_level);
+	}
+}
+
+
+
+/**
+ * @brief	Step the playing scene: interpolate, blend and publish
+ * @detail
+ * 		Deferred to PendSV by scene_period_update(), so the interpolation
+ * 		stays out of the TPM0 overflow interrupt
+ */
+static void scene_update(void){
+
+	/**
+	 * Used to hold the keyframe being moved to, the eased progress towards
+	 * it and the resulting levels
+	 */
+	const scene_keyframe_t *keyframe;
+	int32_t eased;
+	int16_t to[3];
+	int16_t level[3];
+	uint8_t next;
+	bool ended = false;
+
+
+
+	/**
+	 * The scene may have been stopped since this was deferred
+	 */
+	if(!scene_active){
+		return;
+	}
+
+
+
+	/**
+	 * Interpolate towards the keyframe, or land on it once its time is up
+	 */
+	keyframe = &scene_playing->keyframes[scene_keyframe];
+	to[0] = keyframe->red;
+	to[1] = keyframe->green;
+	to[2] = keyframe->blue;
+	scene_elapsed_q8 += SCENE_UPDATE_MS_Q8;
+
+	if(scene_elapsed_q8 >= ((uint32_t)keyframe->time_ms << 8)){
+		for(int channel = 0; channel < 3; channel++){
+			level[channel] = to[channel];
+			scene_from[channel] = to[channel];
+		}
+		next = scene_keyframe + 1;
+		if(next >= scene_playing->count){
+			ended = !scene_playing->loop;
+			next = 0;
+		}
+		scene_enter_keyframe(next);
+	}
+	else{
+		eased = fade_ease((int32_t)((scene_elapsed_q8 * scene_rate) >> 16), (fade_curve_t)keyframe->easing);
+		for(int channel = 0; channel < 3; channel++){
+			level[channel] = (int16_t)(scene_from[channel] +
+				((((int32_t)(to[channel] - scene_from[channel]) * eased) + (FADE_ONE_Q15 / 2)) >> 15));
+		}
+	}
+
+
+
+	/**
+	 * Blend with the tilt color and publish for the next PWM period. A scene
+	 * that does not loop hands the LEDs back once its last keyframe is out
+	 */
+	publish_rgb_levels(
+		scene_blend(level[0], scene_input[0]),
+		scene_blend(level[1], scene_input[1]),
+		scene_blend(level[2], scene_input[2]));
+	if(ended){
+		scene_active = false;
+	}
+}
+
+
+
+int start_scene(const scene_t *scene, scene_blend_t scene_blend, uint8_t blend_amount){
+
+	/**
+	 * Used to hold the first keyframe
+	 */
+	const scene_keyframe_t *first;
+
+
+
+	/**
+	 * A fade owns the LEDs until it ends
+	 */
+	if((scene == NULL) || (scene->count == 0) || fade_active){
+		return EXIT_FAILURE;
+	}
+
+
+
+	/**
+	 * Stop the TPM0 overflow from stepping the old scene while the new one
+	 * is set up, then start from the first keyframe
+	 */
+	scene_active = false;
+	scene_playing = scene;
+	scene_blend_mode = scene_blend;
+	scene_blend_weight = (uint16_t)(blend_amount + (blend_amount >> 7));
+	scene_periods = 0;
+
+	first = &scene->keyframes[0];
+	scene_from[0] = first->red;
+	scene_from[1] = first->green;
+	scene_from[2] = first->blue;
+	scene_enter_keyframe((scene->count > 1) ? 1 : 0);
+
+	set_deferred_handler(deferred_scene, scene_update);
+	scene_active = true;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+void stop_scene(void){
+
+	scene_active = false;
+}
+
+
+
+void set_scene_input(int16_t red_level, int16_t green_level, int16_t blue_level){
+
+	/**
+	 * Used to restore interrupts once all three are stored
+	 */
+	uint32_t irq_mask;
+
+	irq_mask = DisableGlobalIRQ();
+	scene_input[0] = scene_clamp(red_level);
+	scene_input[1] = scene_clamp(green_level);
+	scene_input[2] = scene_clamp(blue_level);
+	EnableGlobalIRQ(irq_mask);
+}
+
+
+
+void scene_period_update(void){
+
+	/**
+	 * Every SCENE_UPDATE_PERIODS PWM periods, have PendSV step the scene
+	 */
+	if(!scene_active){
+		return;
+	}
+	if(++scene_periods < SCENE_UPDATE_PERIODS){
+		return;
+	}
+	scene_periods = 0;
+	defer_work(deferred_scene);
+}
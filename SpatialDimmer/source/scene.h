@@ -0,0 +1,159 @@
+/**
+ * @file	scene.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros, types and function headers for keyframe LED scenes
+ */
+
+
+
+#ifndef SCENE_H_
+#define SCENE_H_
+
+
+
+/**
+ * @brief	How often a playing scene is interpolated, in Hz. Rounded to a
+ * 			whole amount of PWM periods
+ */
+#define SCENE_UPDATE_HZ\
+	(250)
+
+
+
+/**
+ * @brief	One keyframe of a scene
+ * @detail
+ * 		time_ms:	How long it takes to move from the previous keyframe to
+ * 					this one. For the first keyframe of a looping scene it is
+ * 					the time taken to wrap around from the last keyframe
+ * 		red:		The red level reached at this keyframe
+ * 		green:		The green level reached at this keyframe
+ * 		blue:		The blue level reached at this keyframe
+ * 		easing:		How the move to this keyframe is eased (a fade_curve_t)
+ *
+ * 		Six bytes, so scenes cost little flash
+ */
+typedef struct scene_keyframe_s{
+	uint16_t time_ms;
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+	uint8_t easing;
+} scene_keyframe_t;
+
+
+
+/**
+ * @brief	A scene, kept const so it lives in flash
+ * @detail
+ * 		keyframes:	The keyframes in playback order
+ * 		count:		The amount of keyframes, at least 1
+ * 		loop:		Wrap around to the first keyframe after the last instead of
+ * 					ending
+ */
+typedef struct scene_s{
+	const scene_keyframe_t *keyframes;
+	uint8_t count;
+	bool loop;
+} scene_t;
+
+
+
+/**
+ * @brief	Used to select how a playing scene is mixed with the levels mapped
+ * 			from the accelerometer
+ * @detail
+ * 		scene_blend_none:		The scene alone drives the LEDs
+ * 		scene_blend_mix:		Cross-fade from the tilt color to the scene by
+ * 								the blend amount
+ * 		scene_blend_multiply:	The scene scales the tilt color channel by
+ * 								channel, e.g. a white breathing scene breathes
+ * 								the tilt color
+ */
+typedef enum scene_blend_e{
+	scene_blend_none,
+	scene_blend_mix,
+	scene_blend_multiply
+} scene_blend_t;
+
+
+
+/**
+ * @brief	Defined in scene.c
+ */
+extern volatile bool scene_active;
+
+
+
+/**
+ * @brief	Defined in scene.c
+ */
+extern const scene_t scene_breathing;
+
+
+
+/**
+ * @brief	Defined in scene.c
+ */
+extern const scene_t scene_color_cycle;
+
+
+
+/**
+ * @brief	Defined in scene.c
+ */
+extern const scene_t scene_alert;
+
+
+
+/**
+ * @brief	Start playing a scene from its first keyframe
+ * @param	scene - The scene to play
+ * @param	scene_blend - How to mix the scene with the tilt color
+ * @param	blend_amount - For scene_blend_mix, how much of the scene to use,
+ * 			between 0 (tilt only) and 255 (scene only)
+ * @return	EXIT_SUCCESS if started, EXIT_FAILURE if the scene has no
+ * 			keyframes or a fade is running
+ * @detail
+ * 		Starting a scene while one is playing replaces it. A fade cannot
+ * 		start while a scene plays either, so the two never share the LEDs
+ */
+int start_scene(const scene_t *scene, scene_blend_t scene_blend, uint8_t blend_amount);
+
+
+
+/**
+ * @brief	Stop the playing scene, handing the LEDs back to the pipeline
+ */
+void stop_scene(void);
+
+
+
+/**
+ * @brief	Hand the levels mapped from the accelerometer to the playing scene
+ * @param	red_level - The tilt red level
+ * @param	green_level - The tilt green level
+ * @param	blue_level - The tilt blue level
+ * @detail
+ * 		Used by the output stage in place of publish_rgb_levels() while a
+ * 		scene plays
+ */
+void set_scene_input(int16_t red_level, int16_t green_level, int16_t blue_level);
+
+
+
+/**
+ * @brief	Advance the playing scene by one PWM period
+ * @detail
+ * 		Called from tpm_period_update() on every TPM0 overflow, where it only
+ * 		counts periods. Every TPM_PWM_HZ / SCENE_UPDATE_HZ periods it defers
+ * 		to PendSV (see deferred.h), which interpolates the scene color
+ * 		between keyframes in fixed point, blends and publishes it. Nothing is
+ * 		allocated and nothing waits; the only divide is one per keyframe
+ */
+void scene_period_update(void);
+
+
+
+#endif /* SCENE_H_ */
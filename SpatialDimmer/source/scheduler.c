@@ -0,0 +1,460 @@
+/**
+ * @file	scheduler.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for the event-driven task scheduler
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "idle.h"
+#include "queue.h"
+#include "scheduler.h"
+#include "timebase.h"
+#include "watchdog.h"
+
+
+
+/**
+ * @brief	The task table being scheduled
+ */
+static scheduler_task_t *scheduler_tasks = NULL;
+static uint8_t scheduler_task_count = 0;
+
+
+
+/**
+ * @brief	Ticks since init_scheduler()
+ */
+static volatile uint32_t scheduler_ticks = 0;
+
+
+
+/**
+ * @brief	The events pushed by interrupts and not yet handled
+ */
+static event_t scheduler_event_items[SCHEDULER_EVENT_QUEUE_SIZE];
+static queue_t scheduler_events = {
+	.items = (uint8_t *)scheduler_event_items,
+	.item_size = sizeof(event_t),
+	.capacity = SCHEDULER_EVENT_QUEUE_SIZE
+};
+
+
+
+/**
+ * @brief	Events dropped because the queue was full
+ */
+static volatile uint32_t scheduler_dropped_events = 0;
+
+
+
+/**
+ * @brief	The task being run, if any, and the first task to miss its
+ * 			deadline, after which the watchdog is left to reset the MCU
+ */
+static scheduler_task_t * volatile scheduler_running_task = NULL;
+static scheduler_task_t * volatile scheduler_late_task = NULL;
+
+
+
+/**
+ * @brief	Ticks that were handled late because tasks ran past them
+ */
+static uint32_t scheduler_missed_ticks = 0;
+
+
+
+/**
+ * @brief	Core clock cycles per tick
+ */
+static uint32_t scheduler_tick_cycles = 0;
+
+
+
+/**
+ * @brief	Cycles spent in tasks since the last print_scheduler_stats(),
+ * 			and when that was
+ */
+static uint32_t scheduler_busy_cycles = 0;
+static uint32_t scheduler_window_start = 0;
+
+
+
+/**
+ * @brief	Feed the watchdog if every supervised task is within its deadline,
+ * 			otherwise stop feeding and record the late task once
+ * @detail
+ * 		Nothing is printed here: the record is kept through the reset and
+ * 		reported at the next boot, so the report cannot be held up behind,
+ * 		or cut into, a printf the main loop is in the middle of
+ */
+static void scheduler_supervise(void){
+
+	/**
+	 * Used to hold the task that was running when the deadline passed
+	 */
+	scheduler_task_t *running;
+
+	if(scheduler_late_task != NULL){
+		return;
+	}
+	for(uint8_t i = 0; i < scheduler_task_count; i++){
+		if((scheduler_tasks[i].deadline_ticks != 0) && ((scheduler_ticks - scheduler_tasks[i].checkin_tick) > scheduler_tasks[i].deadline_ticks)){
+			scheduler_late_task = &scheduler_tasks[i];
+			running = scheduler_running_task;
+			record_watchdog_late_task(scheduler_late_task->name,
+				(running != NULL) ? running->name : NULL,
+				scheduler_late_task->deadline_ticks,
+				scheduler_ticks - scheduler_late_task->checkin_tick,
+				scheduler_ticks);
+			return;
+		}
+	}
+	kick_watchdog();
+}
+
+
+
+int init_scheduler(scheduler_task_t *tasks, uint8_t task_count){
+
+	/**
+	 * Check every task can be scheduled
+	 */
+	scheduler_tick_cycles = SystemCoreClock / SCHEDULER_TICK_HZ;
+	if((scheduler_tick_cycles == 0) || ((scheduler_tick_cycles - 1) > SysTick_LOAD_RELOAD_Msk)){
+		return EXIT_FAILURE;
+	}
+	for(uint8_t i = 0; i < task_count; i++){
+		if(tasks[i].period_ticks == 0){
+			if(tasks[i].handle == NULL){
+				return EXIT_FAILURE;
+			}
+		}
+		else{
+			if(tasks[i].run == NULL){
+				return EXIT_FAILURE;
+			}
+			if(tasks[i].countdown == 0){
+				tasks[i].countdown = tasks[i].period_ticks;
+			}
+		}
+
+
+
+		/**
+		 * Work out the budget in cycles, and start the deadline from now
+		 */
+		if(tasks[i].budget_us != 0){
+			tasks[i].budget_cycles = tasks[i].budget_us * (SystemCoreClock / 1000000UL);
+		}
+		else{
+			tasks[i].budget_cycles = ((tasks[i].period_ticks == 0) ? 1 : tasks[i].period_ticks) * scheduler_tick_cycles;
+		}
+		tasks[i].checkin_tick = 0;
+	}
+	scheduler_tasks = tasks;
+	scheduler_task_count = task_count;
+
+
+
+	/**
+	 * Configure SysTick:
+	 * 	- Reload every 1 / SCHEDULER_TICK_HZ from the core clock
+	 * 	- Interrupt on every reload at the supervisor priority, above PendSV
+	 * 	  and the event interrupts but below the urgent, PWM and DMA
+	 * 	  interrupts, which are never held up by it
+	 * 	- Start from an empty queue, dropping events pushed before now
+	 */
+	SysTick->CTRL = 0;
+	SysTick->LOAD = scheduler_tick_cycles - 1;
+	SysTick->VAL = 0;
+	NVIC_SetPriority(SysTick_IRQn, SCHEDULER_SUPERVISOR_PRIORITY);
+	flush_queue(&scheduler_events);
+	scheduler_dropped_events = 0;
+	SysTick->CTRL =
+		SysTick_CTRL_CLKSOURCE_Msk |
+		SysTick_CTRL_TICKINT_Msk |
+		SysTick_CTRL_ENABLE_Msk;
+
+	scheduler_window_start = get_scheduler_cycles();
+
+	return EXIT_SUCCESS;
+}
+
+
+
+void push_event(event_type_t type, uint8_t data){
+
+	/**
+	 * Used to hold the event being pushed
+	 */
+	uint32_t irq_mask;
+	event_t event;
+
+	event.type = (uint8_t)type;
+	event.data = data;
+
+
+
+	/**
+	 * SysTick and the event interrupts sit at different priorities, so keep
+	 * one push from being split by another
+	 */
+	irq_mask = DisableGlobalIRQ();
+	event.timestamp_us = get_timebase_us();
+	if(!push_queue(&scheduler_events, &event)){
+		scheduler_dropped_events++;
+	}
+	EnableGlobalIRQ(irq_mask);
+}
+
+
+
+void SysTick_Handler(void){
+
+	scheduler_ticks++;
+	push_event(event_tick, 0);
+	scheduler_supervise();
+}
+
+
+
+uint32_t get_scheduler_cycles(void){
+
+	/**
+	 * Used to hold a consistent tick count and SysTick value
+	 */
+	uint32_t irq_mask;
+	uint32_t ticks;
+	uint32_t value;
+
+
+
+	/**
+	 * A reload may have happened without its interrupt having run yet, in
+	 * which case count its tick and read SysTick again past the reload
+	 */
+	irq_mask = DisableGlobalIRQ();
+	ticks = scheduler_ticks;
+	value = SysTick->VAL;
+	if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk){
+		ticks++;
+		value = SysTick->VAL;
+	}
+	EnableGlobalIRQ(irq_mask);
+
+	return ((ticks * scheduler_tick_cycles) + (scheduler_tick_cycles - 1 - value));
+}
+
+
+
+/**
+ * @brief	Sleep until an interrupt, in the deepest mode that still wakes in
+ * 			time for the next tick
+ * @detail
+ * 		Called with interrupts masked. SysTick stops in VLPS, so after it the
+ * 		current period is reloaded with what was left of it less the time
+ * 		slept, keeping ticks and get_scheduler_cycles() on time
+ */
+static void scheduler_idle(void){
+
+	/**
+	 * Used to hold the cycles until the tick and the cycles slept in VLPS
+	 */
+	uint32_t cycles_per_us = SystemCoreClock / 1000000UL;
+	uint32_t remaining = SysTick->VAL;
+	uint32_t slept_cycles;
+
+	slept_cycles = enter_idle(remaining / cycles_per_us) * cycles_per_us;
+	if(slept_cycles == 0){
+		return;
+	}
+
+
+
+	/**
+	 * If the tick came due while asleep, take it now and start the next
+	 * period from here
+	 */
+	if((slept_cycles + cycles_per_us) >= remaining){
+		SysTick->VAL = 0;
+		SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+		return;
+	}
+
+
+
+	/**
+	 * Otherwise reload the rest of the period once. Writing VAL clears it,
+	 * and SysTick reloads from LOAD on the next clock, after which the
+	 * period can be put back for the reloads that follow
+	 */
+	SysTick->LOAD = remaining - slept_cycles - 1;
+	SysTick->VAL = 0;
+	while(SysTick->VAL == 0);
+	SysTick->LOAD = scheduler_tick_cycles - 1;
+}
+
+
+
+/**
+ * @brief	Run a task, accounting the cycles it takes
+ * @param	task - The task to run
+ * @param	event - The event to hand an event task
+ */
+static void scheduler_run_task(scheduler_task_t *task, const event_t *event){
+
+	/**
+	 * Used to time the run
+	 */
+	uint32_t start;
+	uint32_t cycles;
+
+	scheduler_running_task = task;
+	start = get_scheduler_cycles();
+	if(task->period_ticks == 0){
+		task->handle(event);
+	}
+	else{
+		task->run();
+	}
+	cycles = get_scheduler_cycles() - start;
+	scheduler_running_task = NULL;
+
+
+
+	/**
+	 * Check in with the supervisor, and count a run over budget
+	 */
+	task->checkin_tick = scheduler_ticks;
+	task->runs++;
+	task->total_cycles += cycles;
+	if(cycles > task->max_cycles){
+		task->max_cycles = cycles;
+	}
+	if(cycles > task->budget_cycles){
+		task->overruns++;
+	}
+	scheduler_busy_cycles += cycles;
+}
+
+
+
+void run_scheduler(void){
+
+	/**
+	 * Used to hold the event being handled
+	 */
+	event_t event;
+	scheduler_task_t *task;
+
+	while(1){
+
+		/**
+		 * Sleep until an interrupt pushes an event. Interrupts are masked
+		 * around the check so an event cannot slip in between it and the
+		 * sleep; the sleep still ends on the pending interrupt
+		 */
+		__disable_irq();
+		if(get_queue_count(&scheduler_events) == 0){
+			scheduler_idle();
+		}
+		__enable_irq();
+
+
+
+		/**
+		 * Handle every event waiting, oldest first
+		 */
+		while(pop_queue(&scheduler_events, &event)){
+
+			/**
+			 * A tick runs every periodic task due on it in table order,
+			 * noting if it was handled a tick or more late
+			 */
+			if(event.type == event_tick){
+				if((get_timebase_us() - event.timestamp_us) >= (TIMEBASE_HZ / SCHEDULER_TICK_HZ)){
+					scheduler_missed_ticks++;
+				}
+				for(uint8_t i = 0; i < scheduler_task_count; i++){
+					task = &scheduler_tasks[i];
+					if((task->period_ticks == 0) || (--task->countdown != 0)){
+						continue;
+					}
+					task->countdown = task->period_ticks;
+					scheduler_run_task(task, &event);
+				}
+			}
+
+
+
+			/**
+			 * Any other event runs the tasks handling its type in table order
+			 */
+			else{
+				for(uint8_t i = 0; i < scheduler_task_count; i++){
+					task = &scheduler_tasks[i];
+					if((task->period_ticks == 0) && (task->event == event.type)){
+						scheduler_run_task(task, &event);
+					}
+				}
+			}
+		}
+	}
+}
+
+
+
+void print_scheduler_stats(void){
+
+	/**
+	 * Used to hold the window the CPU load is taken over
+	 */
+	uint32_t now = get_scheduler_cycles();
+	uint32_t window = now - scheduler_window_start;
+	scheduler_task_t *task;
+
+
+
+	/**
+	 * Print each task's average and longest run, and its runs over budget,
+	 * in cycles
+	 */
+	for(uint8_t i = 0; i < scheduler_task_count; i++){
+		task = &scheduler_tasks[i];
+		printf("TASK %s: %lu runs, %lu avg, %lu max cycles, %lu overruns of %lu\r\n",
+			task->name,
+			(unsigned long)task->runs,
+			(unsigned long)((task->runs > 0) ? (task->total_cycles / task->runs) : 0),
+			(unsigned long)task->max_cycles,
+			(unsigned long)task->overruns,
+			(unsigned long)task->budget_cycles);
+	}
+
+
+
+	/**
+	 * Print the share of the window spent in tasks, in tenths of a percent.
+	 * The rest was spent asleep or in interrupts
+	 */
+	printf("CPU %lu/1000 busy, %lu missed ticks, %lu dropped events\r\n\n",
+		(unsigned long)((window > 0) ? (((uint64_t)scheduler_busy_cycles * 1000) / window) : 0),
+		(unsigned long)scheduler_missed_ticks,
+		(unsigned long)scheduler_dropped_events);
+	scheduler_busy_cycles = 0;
+	scheduler_window_start = now;
+}
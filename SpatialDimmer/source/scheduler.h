@@ -0,0 +1,192 @@
+/**
+ * @file	scheduler.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros, types and function headers for the event-driven task
+ * 			scheduler
+ */
+
+
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+
+
+/**
+ * @brief	The SysTick rate in Hz. Task periods are whole ticks
+ */
+#define SCHEDULER_TICK_HZ\
+	(100)
+
+
+
+/**
+ * @brief	How many events can wait to be handled. Must be a power of two
+ */
+#define SCHEDULER_EVENT_QUEUE_SIZE\
+	(16)
+
+
+
+/**
+ * @brief	The NVIC priority of the interrupts that push events other than
+ * 			the tick, the lowest, shared with PendSV
+ */
+#define SCHEDULER_EVENT_PRIORITY\
+	((1UL << __NVIC_PRIO_BITS) - 1UL)
+
+
+
+/**
+ * @brief	The NVIC priority of SysTick, which counts ticks and supervises
+ * 			the tasks. Above PendSV and the event interrupts, so neither
+ * 			stalled deferred work nor a busy UART can keep the supervisor from
+ * 			noticing a late task. Below the urgent, PWM and DMA interrupts
+ */
+#define SCHEDULER_SUPERVISOR_PRIORITY\
+	((1UL << __NVIC_PRIO_BITS) - 2UL)
+
+
+
+/**
+ * @brief	The kinds of event that wake the scheduler
+ */
+typedef enum event_type_e{
+	event_tick,
+	event_uart_byte
+} event_type_t;
+
+
+
+/**
+ * @brief	An event pushed by an interrupt for the main loop to handle
+ * @detail
+ * 		timestamp_us:	When the interrupt pushed it, from the timebase
+ * 		type:			An event_type_t
+ * 		data:			The received byte for event_uart_byte, otherwise 0
+ */
+typedef struct event_s{
+	uint64_t timestamp_us;
+	uint8_t type;
+	uint8_t data;
+} event_t;
+
+
+
+/**
+ * @brief	A periodic or event task, its supervision and its run-time
+ * 			accounting
+ * @detail
+ * 		name:			Printed by print_scheduler_stats()
+ * 		run:			Periodic tasks: called once per period. Must return
+ * 						without waiting
+ * 		handle:			Event tasks: called with each event of their type.
+ * 						Must return without waiting
+ * 		event:			Event tasks: the event_type_t they handle
+ * 		period_ticks:	How many ticks between runs, or 0 for an event task
+ * 		deadline_ticks:	The most ticks allowed between the task finishing
+ * 						runs before the watchdog resets the MCU, or 0 to
+ * 						leave the task unsupervised
+ * 		budget_us:		The longest a run should take, or 0 for the
+ * 						period (a tick for event tasks)
+ * 		countdown:		Ticks until the next run. Start tasks that feed each
+ * 						other at the same countdown so they run in table order
+ * 		checkin_tick:	The tick the task last finished a run on
+ * 		budget_cycles:	budget_us in core clock cycles
+ * 		runs:			How many times the task has run
+ * 		overruns:		How many runs took longer than the budget
+ * 		total_cycles:	Core clock cycles spent in the task
+ * 		max_cycles:		Core clock cycles of the longest run
+ */
+typedef struct scheduler_task_s{
+	const char *name;
+	void (*run)(void);
+	void (*handle)(const event_t *event);
+	uint8_t event;
+	uint16_t period_ticks;
+	uint16_t deadline_ticks;
+	uint32_t budget_us;
+	uint16_t countdown;
+	volatile uint32_t checkin_tick;
+	uint32_t budget_cycles;
+	uint32_t runs;
+	uint32_t overruns;
+	uint64_t total_cycles;
+	uint32_t max_cycles;
+} scheduler_task_t;
+
+
+
+/**
+ * @brief	Start SysTick, take the task table to schedule and supervise
+ * 			the tasks with the watchdog
+ * @param	tasks - The task table, in the order tasks due on the same tick
+ * 			run
+ * @param	task_count - The amount of tasks in the table
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if a task has neither a period nor
+ * 			an event handler, or the core clock cannot be divided down to
+ * 			SCHEDULER_TICK_HZ
+ * @detail
+ * 		Events pushed before this are discarded.
+ *
+ * 		Every tick the SysTick interrupt checks each supervised task has
+ * 		finished a run within its deadline, and only then feeds the watchdog
+ * 		(see watchdog.h). When one has not, feeding stops and the late task,
+ * 		the task running and how late it is are recorded in RAM that survives
+ * 		the reset. The COP resets the MCU within WATCHDOG_TIMEOUT_MS, and the
+ * 		record is printed at the next boot. A task that never returns is
+ * 		caught as long as SysTick still runs
+ */
+int init_scheduler(scheduler_task_t *tasks, uint8_t task_count);
+
+
+
+/**
+ * @brief	Handle events as they arrive and sleep in between. Never returns
+ * @detail
+ * 		Each event is handled in arrival order: a tick runs the periodic
+ * 		tasks due on it, any other event runs the tasks handling its type.
+ * 		Tasks run to completion one after another. When the queue is empty
+ * 		the MCU idles in WAIT, or VLPS when the next tick is far enough off
+ * 		(see idle.h). A tick handled a whole tick period or more after it
+ * 		arrived is counted as missed
+ */
+void run_scheduler(void);
+
+
+
+/**
+ * @brief	Push an event for run_scheduler() to handle, stamped with the time
+ * @param	type - The kind of event
+ * @param	data - The event's byte of data, if any
+ * @detail
+ * 		Call from SysTick or interrupts at SCHEDULER_EVENT_PRIORITY. SysTick
+ * 		can preempt the others, so the push itself is made with interrupts
+ * 		masked, keeping the queue to one producer at a time. An event that
+ * 		does not fit in the queue is dropped and counted
+ */
+void push_event(event_type_t type, uint8_t data);
+
+
+
+/**
+ * @brief	Read a free-running count of core clock cycles
+ * @return	Core clock cycles since init_scheduler(), wrapping modulo 2^32
+ * @detail
+ * 		Combines the tick count with SysTick->VAL, so differences are exact
+ * 		across ticks
+ */
+uint32_t get_scheduler_cycles(void);
+
+
+
+/**
+ * @brief	Print each task's accounting, the CPU load since the last call and
+ * 			the events dropped over the debug console
+ */
+void print_scheduler_stats(void);
+
+
+
+#endif /* SCHEDULER_H_ */
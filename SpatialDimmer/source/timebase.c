@@ -0,0 +1,166 @@
+/**
+ * @file	timebase.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for the microsecond timebase
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdlib.h>
+#include "board.h"
+#include "fsl_clock.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "timebase.h"
+
+
+
+/**
+ * @brief	The PIT channel dividing the bus clock down to microseconds
+ */
+#define TIMEBASE_PRESCALE_CHANNEL\
+	(0)
+
+
+
+/**
+ * @brief	The PIT channel counting microseconds, chained to the prescale
+ * 			channel
+ */
+#define TIMEBASE_COUNT_CHANNEL\
+	(1)
+
+
+
+/**
+ * @brief	How many times the count channel has wrapped: the upper 32 bits
+ * 			of the timebase
+ */
+static volatile uint32_t timebase_wraps = 0;
+
+
+
+/**
+ * @brief	Microseconds added to the PIT count for time it spent stopped,
+ * 			in VLPS
+ */
+static volatile uint64_t timebase_offset = 0;
+
+
+
+int init_timebase(void){
+
+	/**
+	 * Used to hold the bus clock cycles per microsecond
+	 */
+	uint32_t bus_hz = CLOCK_GetBusClkFreq();
+
+
+
+	/**
+	 * The prescale channel must expire on whole microseconds
+	 */
+	if((bus_hz < TIMEBASE_HZ) || ((bus_hz % TIMEBASE_HZ) != 0)){
+		return EXIT_FAILURE;
+	}
+
+
+
+	/**
+	 * Enable clock to the PIT and enable the module, with timers continuing
+	 * to run in debug mode
+	 */
+	SIM->SCGC6 |= SIM_SCGC6_PIT_MASK;
+	PIT->MCR = 0;
+
+
+
+	/**
+	 * Configure the channels while stopped:
+	 * 	- Prescale channel reloads every microsecond
+	 * 	- Count channel is chained, so it decrements once per prescale
+	 * 	  expiry, and interrupts when it wraps
+	 * 	- Start the count channel first so no microsecond is lost
+	 */
+	PIT->CHANNEL[TIMEBASE_PRESCALE_CHANNEL].TCTRL = 0;
+	PIT->CHANNEL[TIMEBASE_COUNT_CHANNEL].TCTRL = 0;
+	PIT->CHANNEL[TIMEBASE_PRESCALE_CHANNEL].LDVAL = (bus_hz / TIMEBASE_HZ) - 1;
+	PIT->CHANNEL[TIMEBASE_COUNT_CHANNEL].LDVAL = UINT32_MAX;
+	PIT->CHANNEL[TIMEBASE_COUNT_CHANNEL].TFLG = PIT_TFLG_TIF_MASK;
+	timebase_wraps = 0;
+	timebase_offset = 0;
+	PIT->CHANNEL[TIMEBASE_COUNT_CHANNEL].TCTRL =
+		PIT_TCTRL_CHN_MASK |
+		PIT_TCTRL_TIE_MASK |
+		PIT_TCTRL_TEN_MASK;
+	NVIC_EnableIRQ(PIT_IRQn);
+	PIT->CHANNEL[TIMEBASE_PRESCALE_CHANNEL].TCTRL = PIT_TCTRL_TEN_MASK;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+uint64_t get_timebase_us(void){
+
+	/**
+	 * Used to hold a consistent pair of halves
+	 */
+	uint32_t irq_mask;
+	uint32_t upper;
+	uint32_t lower;
+	uint64_t offset;
+
+
+
+	/**
+	 * If the count channel has wrapped but its interrupt has not run (it is
+	 * masked here, or this is a higher priority interrupt), count the wrap.
+	 * A lower half still near the top was read before the wrap
+	 */
+	irq_mask = DisableGlobalIRQ();
+	upper = timebase_wraps;
+	lower = ~PIT->CHANNEL[TIMEBASE_COUNT_CHANNEL].CVAL;
+	if((PIT->CHANNEL[TIMEBASE_COUNT_CHANNEL].TFLG & PIT_TFLG_TIF_MASK) && (lower < (UINT32_MAX / 2))){
+		upper++;
+	}
+	offset = timebase_offset;
+	EnableGlobalIRQ(irq_mask);
+
+	return ((((uint64_t)upper << 32) | lower) + offset);
+}
+
+
+
+uint32_t get_timebase_us32(void){
+
+	return ((~PIT->CHANNEL[TIMEBASE_COUNT_CHANNEL].CVAL) + (uint32_t)timebase_offset);
+}
+
+
+
+void advance_timebase(uint32_t us){
+
+	timebase_offset += us;
+}
+
+
+
+void PIT_IRQHandler(void){
+
+	/**
+	 * Count a wrap of the count channel (TIF is write 1 to clear)
+	 */
+	if(PIT->CHANNEL[TIMEBASE_COUNT_CHANNEL].TFLG & PIT_TFLG_TIF_MASK){
+		PIT->CHANNEL[TIMEBASE_COUNT_CHANNEL].TFLG = PIT_TFLG_TIF_MASK;
+		timebase_wraps++;
+	}
+}
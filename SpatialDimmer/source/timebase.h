@@ -0,0 +1,72 @@
+/**
+ * @file	timebase.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros and function headers for the microsecond timebase
+ */
+
+
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+
+
+/**
+ * @brief	The timebase resolution in Hz
+ */
+#define TIMEBASE_HZ\
+	(1000000)
+
+
+
+/**
+ * @brief	Start the microsecond timebase from 0
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if the bus clock is not a whole
+ * 			amount of MHz
+ * @detail
+ * 		PIT channel 0 expires every microsecond and clocks channel 1, which is
+ * 		chained to it and counts microseconds down from 2^32 - 1. The PIT
+ * 		interrupt counts each time channel 1 wraps, giving the upper 32 bits
+ */
+int init_timebase(void);
+
+
+
+/**
+ * @brief	Read the timebase
+ * @return	Microseconds since init_timebase(). Monotonic, and wraps after
+ * 			half a million years
+ * @detail
+ * 		Safe from thread and interrupt context: a wrap of channel 1 whose
+ * 		interrupt has not run yet is accounted for, so the result never
+ * 		tears or steps back. Costs one register read and a few instructions
+ * 		with interrupts briefly masked
+ */
+uint64_t get_timebase_us(void);
+
+
+
+/**
+ * @brief	Read the lower 32 bits of the timebase
+ * @return	Microseconds since init_timebase(), wrapping every 71 minutes
+ * @detail
+ * 		A single register read. Enough for measuring intervals shorter than
+ * 		the wrap, since differences are exact modulo 2^32
+ */
+uint32_t get_timebase_us32(void);
+
+
+
+/**
+ * @brief	Account for time the PIT spent stopped
+ * @param	us - The microseconds the PIT missed
+ * @detail
+ * 		The PIT stops with the bus clock in VLPS, so enter_idle() adds the
+ * 		time it measured on the LPTMR. Call with interrupts masked
+ */
+void advance_timebase(uint32_t us);
+
+
+
+#endif /* TIMEBASE_H_ */
@@ -10,7 +10,10 @@
 /**
  * Include pre-defined libraries
  */
+#include <stdbool.h>
+#include <stdlib.h>
 #include "board.h"
+#include "fsl_clock.h"
 
 
 
@@ -18,7 +21,11 @@
  * User-defined libraries
  */
 #include "bitops.h"
-#include "led.h"
+#include "calibration.h"
+#include "deferred.h"
+#include "led.h"		// Keep led.h included before fade.h for led_color_t typedef
+#include "fade.h"
+#include "scene.h"
 #include "tpm.h"
 
 
@@ -49,34 +56,64 @@
 
 
 /**
- * @brief	The frequency of MCGFLLCLK clock in Hz
+ * @brief	How the on-board LED PWM is aligned and where each LED's pulse
+ * 			sits in the period
+ * @detail
+ * 		Green trails red and blue so the LED current steps up in two halves
+ * 		instead of all at once
  */
-#define MCGFLLCLK_HZ\
-	(48000000)
+#define LED_PWM_ALIGNMENT\
+	(tpm_edge_aligned)
+#define RED_LED_PHASE\
+	(tpm_phase_leading)
+#define GREEN_LED_PHASE\
+	(tpm_phase_trailing)
+#define BLUE_LED_PHASE\
+	(tpm_phase_leading)
 
 
 
 /**
- * @brief	The frequency of TPM clock in Hz
+ * @brief	The largest duty, with TPM_DITHER_BITS fractional bits, that fits
+ * 			a 16-bit CnV
  */
-#define TPM_CLOCK_HZ\
-	(MCGFLLCLK_HZ)
+#define MAX_TPM_DUTY\
+	(MASK(0xFFFFUL, TPM_DITHER_BITS))
 
 
 
 /**
- * @brief	The desired frequency of the PWM in Hz
+ * @brief	The largest TPM prescaler, x for 2^x
  */
-#define TPM_PWM_HZ\
-	(500)
+#define MAX_TPM_SC_PS\
+	(7)
 
 
 
 /**
- * @brief	The max division factor for 16-bit TPM->MOD register
+ * @brief	The most counter bits center-aligned PWM can use, since CPWMS
+ * 			only takes a MOD of 0x0001 to 0x7FFF
  */
-#define MAX_TPM_MOD_VALUE\
-	(65536)
+#define MAX_TPM_CPWMS_BITS\
+	(15)
+
+
+
+/**
+ * @brief	The largest MOD center-aligned PWM takes
+ */
+#define MAX_TPM_CPWMS_MOD\
+	(0x7FFF)
+
+
+
+/**
+ * @brief	The power limiter's scale factors are fixed-point with this many
+ * 			fractional bits. Small enough that MAX_TPM_DUTY times a scale fits
+ * 			32 bits
+ */
+#define LED_POWER_SCALE_BITS\
+	(12)
 
 
 
@@ -92,6 +129,17 @@
 
 
 
+/**
+ * @brief	Configuration for TPM trigger select, used to start TPM2 on the
+ * 			TPM0 overflow
+ * @detail
+ * 		8: TPM0 overflow
+ */
+#define CONF_TRGSEL_TPM0_OVERFLOW\
+	(8)
+
+
+
 /**
  * @brief	Selects the LPTPM counter clock modes. When disabling the counter,
  * 			this field remain set until acknowledged in the LPTPM clock domain
@@ -111,7 +159,7 @@
  * @brief	Turn off on-board red LED through analog TPM
  */
 #define ANALOG_CLEAR_RED_LED()\
-	(TPM2->CONTROLS[TPM2_RED_LED_CHANNEL].CnV = 0)
+	(set_dithered_duty(&rgb_duty_staged->red, phase_duty(0, RED_LED_PHASE)))
 
 
 
@@ -119,7 +167,7 @@
  * @brief	Turn off on-board green LED through analog TPM
  */
 #define ANALOG_CLEAR_GREEN_LED()\
-	(TPM2->CONTROLS[TPM2_GREEN_LED_CHANNEL].CnV = 0)
+	(set_dithered_duty(&rgb_duty_staged->green, phase_duty(0, GREEN_LED_PHASE)))
 
 
 
@@ -127,38 +175,224 @@
  * @brief	Turn off on-board blue LED through analog TPM
  */
 #define ANALOG_CLEAR_BLUE_LED()\
-	(TPM0->CONTROLS[TPM0_BLUE_LED_CHANNEL].CnV = 0)
+	(set_dithered_duty(&rgb_duty_staged->blue, phase_duty(0, BLUE_LED_PHASE)))
 
 
 
 /**
- * @brief	Set on-board red LED through analog TPM
+ * @brief	Set on-board red LED through analog TPM to a duty from
+ * 			level_to_duty()
  */
 #define ANALOG_SET_RED_LED(x)\
-	(TPM2->CONTROLS[TPM2_RED_LED_CHANNEL].CnV = x)
+	(set_dithered_duty(&rgb_duty_staged->red, phase_duty(x, RED_LED_PHASE)))
 
 
 
 /**
- * @brief	Set on-board green LED through analog TPM
+ * @brief	Set on-board green LED through analog TPM to a duty from
+ * 			level_to_duty()
  */
 #define ANALOG_SET_GREEN_LED(x)\
-	(TPM2->CONTROLS[TPM2_GREEN_LED_CHANNEL].CnV = x)
+	(set_dithered_duty(&rgb_duty_staged->green, phase_duty(x, GREEN_LED_PHASE)))
 
 
 
 /**
- * @brief	Set on-board blue LED through analog TPM
+ * @brief	Set on-board blue LED through analog TPM to a duty from
+ * 			level_to_duty()
  */
 #define ANALOG_SET_BLUE_LED(x)\
-	(TPM0->CONTROLS[TPM0_BLUE_LED_CHANNEL].CnV = x)
+	(set_dithered_duty(&rgb_duty_staged->blue, phase_duty(x, BLUE_LED_PHASE)))
+
+
+
+#if TPM_GAMMA_CORRECTION
+/**
+ * @brief	CIE 1931 lightness: the 16-bit duty (0 to 65535) that makes each
+ * 			8-bit RGB level look evenly spaced in brightness
+ */
+static const uint16_t cie_lightness_table[RGB_LEVELS] = {
+	    0,    28,    57,    85,   114,   142,   171,   199,
+	  228,   256,   285,   313,   341,   370,   398,   427,
+	  455,   484,   512,   541,   569,   598,   627,   658,
+	  689,   721,   755,   789,   825,   861,   899,   937,
+	  977,  1018,  1060,  1103,  1147,  1192,  1239,  1287,
+	 1336,  1386,  1437,  1490,  1544,  1599,  1656,  1714,
+	 1773,  1834,  1896,  1959,  2024,  2090,  2157,  2226,
+	 2297,  2369,  2442,  2517,  2593,  2671,  2751,  2832,
+	 2914,  2999,  3085,  3172,  3261,  3352,  3444,  3538,
+	 3634,  3732,  3831,  3932,  4035,  4139,  4245,  4354,
+	 4464,  4575,  4689,  4804,  4922,  5041,  5162,  5285,
+	 5410,  5537,  5666,  5797,  5930,  6065,  6202,  6341,
+	 6482,  6626,  6771,  6918,  7068,  7220,  7373,  7529,
+	 7687,  7848,  8010,  8175,  8342,  8512,  8683,  8857,
+	 9033,  9212,  9393,  9576,  9762,  9949, 10140, 10333,
+	10528, 10725, 10926, 11128, 11333, 11541, 11751, 11963,
+	12179, 12396, 12617, 12840, 13065, 13293, 13524, 13757,
+	13993, 14232, 14474, 14718, 14965, 15215, 15467, 15722,
+	15980, 16241, 16505, 16771, 17041, 17313, 17588, 17866,
+	18147, 18431, 18717, 19007, 19300, 19596, 19894, 20196,
+	20501, 20809, 21119, 21433, 21750, 22071, 22394, 22720,
+	23050, 23383, 23719, 24058, 24400, 24746, 25095, 25447,
+	25802, 26161, 26523, 26888, 27257, 27629, 28004, 28383,
+	28765, 29151, 29540, 29932, 30328, 30728, 31131, 31537,
+	31947, 32360, 32777, 33198, 33622, 34050, 34481, 34916,
+	35355, 35797, 36243, 36693, 37146, 37603, 38064, 38529,
+	38997, 39469, 39945, 40425, 40908, 41396, 41887, 42382,
+	42881, 43384, 43891, 44401, 44916, 45435, 45957, 46484,
+	47015, 47549, 48088, 48631, 49178, 49728, 50283, 50843,
+	51406, 51973, 52545, 53120, 53700, 54284, 54873, 55465,
+	56062, 56663, 57269, 57878, 58492, 59111, 59733, 60360,
+	60992, 61627, 62268, 62912, 63561, 64215, 64873, 65535
+};
+#endif
+
+
+
+/**
+ * @brief	The value loaded into TPM->MOD of the on-board LED instances,
+ * 			derived from TPM_PWM_HZ
+ */
+uint16_t tpm_mod = 0;
+
+
+
+/**
+ * @brief	The clock gate of each TPM instance
+ */
+typedef struct tpm_instance_s{
+	TPM_Type *instance;
+	uint32_t scgc6_mask;
+} tpm_instance_t;
+
+static const tpm_instance_t tpm_instances[] = {
+	{TPM0, SIM_SCGC6_TPM0_MASK},
+	{TPM1, SIM_SCGC6_TPM1_MASK},
+	{TPM2, SIM_SCGC6_TPM2_MASK}
+};
+
+
+
+/**
+ * @brief	The on-board LED instances: red and green on TPM2, blue on TPM0
+ */
+static const tpm_config_t tpm2_led_config = {
+	.instance = TPM2,
+	.channels = (MASK(1U, TPM2_RED_LED_CHANNEL) | MASK(1U, TPM2_GREEN_LED_CHANNEL)),
+	.pwm_hz = TPM_PWM_HZ,
+	.resolution_bits = TPM_PWM_RESOLUTION_BITS,
+	.alignment = LED_PWM_ALIGNMENT,
+	.phase = {
+		[TPM2_RED_LED_CHANNEL] = RED_LED_PHASE,
+		[TPM2_GREEN_LED_CHANNEL] = GREEN_LED_PHASE
+	}
+};
+
+static const tpm_config_t tpm0_led_config = {
+	.instance = TPM0,
+	.channels = MASK(1U, TPM0_BLUE_LED_CHANNEL),
+	.pwm_hz = TPM_PWM_HZ,
+	.resolution_bits = TPM_PWM_RESOLUTION_BITS,
+	.alignment = LED_PWM_ALIGNMENT,
+	.phase = {
+		[TPM0_BLUE_LED_CHANNEL] = BLUE_LED_PHASE
+	}
+};
+
+
+
+/**
+ * @brief	How long after each TPM0 overflow its interrupt started, in TPM0
+ * 			counts
+ */
+static latency_t pwm_commit_latency = {0};
+
+
+
+/**
+ * @brief	The TPM duty for each RGB level at the current TPM->MOD, with
+ * 			TPM_DITHER_BITS fractional bits. Built once by init_duty_table() so
+ * 			an update is a single table lookup
+ */
+static uint32_t duty_table[RGB_LEVELS];
+
+
+
+/**
+ * @brief	The power limiter's state, built by init_duty_table()
+ * @detail
+ * 		led_power_budget:		LED_POWER_BUDGET_MA in the units of a weighted
+ * 								duty sum (mA times duty)
+ * 		led_power_shift:		Shifts a weighted duty sum down to an index
+ * 								into led_power_reciprocals
+ * 		led_power_reciprocals:	The scale, with LED_POWER_SCALE_BITS
+ * 								fractional bits, that brings the largest sum of
+ * 								each index back to the budget
+ */
+static uint32_t led_power_budget;
+static uint8_t led_power_shift;
+static uint16_t led_power_reciprocals[LED_POWER_RECIPROCALS];
+
+
+
+/**
+ * @brief	The dither state of one LED channel: the whole CnV count and the
+ * 			pattern of periods which get one count more
+ */
+typedef struct dither_state_s{
+	uint16_t base;
+	uint16_t pattern;
+} dither_state_t;
+
+
+
+/**
+ * @brief	The duty and dither state of all three LED channels
+ */
+typedef struct rgb_duty_s{
+	dither_state_t red;
+	dither_state_t green;
+	dither_state_t blue;
+} rgb_duty_t;
+
+
+
+/**
+ * @brief	Double buffer of LED duties. tpm_period_update() outputs
+ * 			rgb_duty_buffers[rgb_duty_active] while the other is staged
+ * @detail
+ * 		A new triple is staged and published by setting rgb_duty_pending.
+ * 		The next TPM0 overflow swaps the buffers, so all three channels
+ * 		change on the same PWM period and never mid-period
+ */
+static volatile rgb_duty_t rgb_duty_buffers[2];
+static volatile uint8_t rgb_duty_active = 0;
+static volatile bool rgb_duty_pending = false;
 
 
 
 /**
- * @brief	The total amount of possible RGB values
+ * @brief	The buffer being staged by analog_control_onboard_leds()
  */
-int rgb_levels = ((RGB_MAX - RGB_MIN) + 1);
+static volatile rgb_duty_t *rgb_duty_staged = &rgb_duty_buffers[1];
+
+
+
+/**
+ * @brief	The pattern for each fractional duty. Bit n is set if period n of
+ * 			the pattern gets one count more
+ * @detail
+ * 		Set periods are spread by bit-reversed order, so a fraction of 1/2
+ * 		alternates every period instead of running high for half the pattern
+ */
+static uint16_t dither_patterns[TPM_DITHER_PHASES];
+
+
+
+/**
+ * @brief	The current period within the dither pattern
+ */
+static uint8_t dither_phase = 0;
 
 
 
@@ -210,200 +444,531 @@ int8_t step_blue_level = 4;
 
 
 
-void init_onboard_tpm0(uint32_t channel, uint16_t mod){
+/**
+ * @brief	Look up the TPM duty for an RGB level
+ * @param	level - The RGB level, clamped to between RGB_MIN and RGB_MAX
+ * @return	The value to load into TPM->CONTROLS[n].CnV
+ */
+static inline uint32_t level_to_duty(int16_t level){
+
+	if(level < RGB_MIN){
+		level = RGB_MIN;
+	}
+	else if(level > RGB_MAX){
+		level = RGB_MAX;
+	}
+
+	return (duty_table[level - RGB_MIN]);
+}
+
+
+
+/**
+ * @brief	Scale an RGB triple of duties down to LED_POWER_BUDGET_MA
+ * @param	duty - The red, green and blue duties, scaled in place
+ * @detail
+ * 		Under budget this costs three multiplies and a compare. Over budget
+ * 		the scale is looked up rather than divided out, rounding the sum up
+ * 		to its table entry so the result never exceeds the budget
+ */
+static inline void limit_rgb_power(uint32_t duty[3]){
+
+	/**
+	 * Used to hold the weighted duty sum and the scale to apply
+	 */
+	uint32_t power;
+	uint32_t scale;
+
+	power =
+		(LED_RED_FULL_MA * duty[0]) +
+		(LED_GREEN_FULL_MA * duty[1]) +
+		(LED_BLUE_FULL_MA * duty[2]);
+	if(power <= led_power_budget){
+		return;
+	}
+
+	scale = led_power_reciprocals[power >> led_power_shift];
+	duty[0] = (duty[0] * scale) >> LED_POWER_SCALE_BITS;
+	duty[1] = (duty[1] * scale) >> LED_POWER_SCALE_BITS;
+	duty[2] = (duty[2] * scale) >> LED_POWER_SCALE_BITS;
+}
+
+
+
+/**
+ * @brief	Convert a duty to the CnV duty for a channel's phase
+ * @param	duty - The duty with TPM_DITHER_BITS fractional bits
+ * @param	tpm_phase - Where the channel's pulse sits in the period
+ * @return	The CnV duty with TPM_DITHER_BITS fractional bits
+ * @detail
+ * 		Trailing channels use high-true output, so the LED is on for the
+ * 		counts after CnV and CnV is the complement of the duty. Dithering
+ * 		the complement still averages to the requested duty
+ */
+static inline uint32_t phase_duty(uint32_t duty, tpm_phase_t tpm_phase){
+
+	if(tpm_phase == tpm_phase_trailing){
+		duty = ((((uint32_t)tpm_mod + 1) << TPM_DITHER_BITS) - duty);
+		if(duty > MAX_TPM_DUTY){
+			duty = MAX_TPM_DUTY;
+		}
+	}
+
+	return (duty);
+}
+
+
+
+/**
+ * @brief	Take back the staged buffer to build a new RGB triple in
+ * @param	keep_untouched - Start from the duties being output if the staged
+ * 			buffer was already committed, so channels not written keep their
+ * 			level
+ * @detail
+ * 		Call with interrupts masked, and keep them masked until the triple
+ * 		is built and rgb_duty_pending is set again. The TPM0 overflow then
+ * 		cannot commit a half built triple, and no other writer, such as
+ * 		the fade completing in DMA2_IRQHandler(), can mix its own into it
+ */
+static void stage_rgb_duty(bool keep_untouched){
+
+	/**
+	 * Used to remember whether the staged buffer still holds an
+	 * uncommitted triple
+	 */
+	bool was_pending = rgb_duty_pending;
+
+	rgb_duty_pending = false;
+	rgb_duty_staged = &rgb_duty_buffers[rgb_duty_active ^ 1];
+	if(keep_untouched && !was_pending){
+		*rgb_duty_staged = rgb_duty_buffers[rgb_duty_active];
+	}
+}
+
+
+
+/**
+ * @brief	Split a duty into the whole CnV count and its dither pattern
+ * @param	dither - The staged dither state of the channel
+ * @param	duty - The duty with TPM_DITHER_BITS fractional bits
+ */
+static inline void set_dithered_duty(volatile dither_state_t *dither, uint32_t duty){
+
+	dither->base = (uint16_t)(duty >> TPM_DITHER_BITS);
+	dither->pattern = dither_patterns[duty & (TPM_DITHER_PHASES - 1)];
+}
+
+
+
+void init_onboard_tpm(void){
 
 	/**
-	 * Enable clock to TPM module 0
+	 * Configure both instances with their counters stopped
 	 */
-	SIM->SCGC6 |= SIM_SCGC6_TPM0_MASK;
+	init_tpm(&tpm2_led_config);
+	init_tpm(&tpm0_led_config);
+	tpm_mod = (uint16_t)TPM0->MOD;
+	init_duty_table();
 
 
 
 	/**
-	 * Configure SOPT2:
-	 * 	- To use MCGFLLCLK as clock source
+	 * Configure the TPM2 CONF register:
+	 * 	- Hold the counter once started until the first TPM0 overflow, so
+	 * 	  TPM2 and TPM0 periods begin together
 	 */
-	SIM->SOPT2 &=
-		~(SIM_SOPT2_TPMSRC_MASK |
-		SIM_SOPT2_PLLFLLSEL_MASK);
-	SIM->SOPT2 |=
-		SIM_SOPT2_TPMSRC(SOPT2_TPMSRC) |
-		SIM_SOPT2_PLLFLLSEL(SOPT2_PLLFLLSEL);
+	TPM2->CONF |=
+		TPM_CONF_TRGSEL(CONF_TRGSEL_TPM0_OVERFLOW) |
+		TPM_CONF_CSOT_MASK;
+	TPM2->SC |= TPM_SC_CMOD(SC_CMOD);
 
 
 
 	/**
-	 * Set the smallest needed prescaler along with PWM period for
-	 * desired PWM frequency
-	 *
-	 * TPM->SC[PS] holds x for 2^x, where 2^x is the tpm_prescaler
-	 *
-	 * Configure the TPM SC register:
-	 * 	- Count up with divide by tpm_prescaler
+	 * Commit published duties and step the dither pattern on every TPM0
+	 * overflow. TPM2 is started by this overflow, so its channels are
+	 * updated from here too
 	 */
+	TPM0->SC |= TPM_SC_TOIE_MASK;
+	NVIC_EnableIRQ(TPM0_IRQn);
+	TPM0->SC |= TPM_SC_CMOD(SC_CMOD);
+}
+
+
+
+int init_tpm(const tpm_config_t *tpm_config){
+
+	/**
+	 * Used to hold the instance's clock gate and its timing
+	 */
+	const tpm_instance_t *tpm_instance = NULL;
+	TPM_Type *tpm = tpm_config->instance;
+	uint32_t counts;
+	uint8_t resolution_bits;
 	uint8_t tpm_sc_ps;
-	tpm_sc_ps = get_smallest_prescaler(TPM_CLOCK_HZ, TPM_PWM_HZ);
-	TPM0->SC = TPM_SC_PS(tpm_sc_ps);
 
 
 
 	/**
-	 * Load the TPM MOD register
+	 * Look up the instance and check the frequency is reachable
+	 */
+	for(uint32_t i = 0; i < (sizeof(tpm_instances) / sizeof(tpm_instances[0])); i++){
+		if(tpm_instances[i].instance == tpm){
+			tpm_instance = &tpm_instances[i];
+		}
+	}
+	if((tpm_instance == NULL) || (tpm_config->pwm_hz == 0)){
+		return EXIT_FAILURE;
+	}
+
+
+
+	/**
+	 * Configure SOPT2 once for all instances:
+	 * 	- To use MCGPLLCLK / 2 as clock source
+	 */
+	if((SIM->SOPT2 & (SIM_SOPT2_TPMSRC_MASK | SIM_SOPT2_PLLFLLSEL_MASK)) !=
+		(SIM_SOPT2_TPMSRC(SOPT2_TPMSRC) | SIM_SOPT2_PLLFLLSEL(SOPT2_PLLFLLSEL))){
+		SIM->SOPT2 &=
+			~(SIM_SOPT2_TPMSRC_MASK |
+			SIM_SOPT2_PLLFLLSEL_MASK);
+		SIM->SOPT2 |=
+			SIM_SOPT2_TPMSRC(SOPT2_TPMSRC) |
+			SIM_SOPT2_PLLFLLSEL(SOPT2_PLLFLLSEL);
+	}
+
+
+
+	/**
+	 * Set the smallest needed prescaler along with PWM period for the
+	 * desired PWM frequency, from the clock actually feeding the TPM
 	 */
-	TPM0->MOD = mod;
+	counts = CLOCK_GetFreq(kCLOCK_PllFllSelClk) / tpm_config->pwm_hz;
+	resolution_bits = tpm_config->resolution_bits;
+	if(tpm_config->alignment == tpm_center_aligned){
+		counts >>= 1;
+		if(resolution_bits > MAX_TPM_CPWMS_BITS){
+			resolution_bits = MAX_TPM_CPWMS_BITS;
+		}
+	}
+	tpm_sc_ps = get_tpm_prescaler(counts, resolution_bits);
+	if((tpm_sc_ps > MAX_TPM_SC_PS) || ((counts >> tpm_sc_ps) < 2)){
+		return EXIT_FAILURE;
+	}
+	if((tpm_config->alignment == tpm_center_aligned) && ((counts >> tpm_sc_ps) > MAX_TPM_CPWMS_MOD)){
+		return EXIT_FAILURE;
+	}
 
 
 
 	/**
-	 * Configure the TPM CONF register:
+	 * Enable clock to the TPM module and configure it while stopped:
+	 * 	- Count up (edge-aligned) or up-down (center-aligned) with divide
+	 * 	  by 2^tpm_sc_ps
+	 * 	- Load the TPM MOD register. An up-down period is 2 * MOD counts
 	 * 	- Continue counting operation in debug mode
 	 */
-	TPM0->CONF |= TPM_CONF_DBGMODE(CONF_DBGMODE);
+	SIM->SCGC6 |= tpm_instance->scgc6_mask;
+	tpm->SC = 0;
+	tpm->CNT = 0;
+	if(tpm_config->alignment == tpm_center_aligned){
+		tpm->SC = TPM_SC_PS(tpm_sc_ps) | TPM_SC_CPWMS_MASK;
+		tpm->MOD = (uint16_t)(counts >> tpm_sc_ps);
+	}
+	else{
+		tpm->SC = TPM_SC_PS(tpm_sc_ps);
+		tpm->MOD = (uint16_t)((counts >> tpm_sc_ps) - 1);
+	}
+	tpm->CONF |= TPM_CONF_DBGMODE(CONF_DBGMODE);
+
+
+
+	/**
+	 * Configure TPM CnSC of each selected channel:
+	 * 	- PWM
+	 * 	- Leading: low-true pulses (set output on match, clear output on
+	 * 	  reload), so the active-low LED is on before CnV
+	 * 	- Trailing: high-true pulses (clear output on match, set output on
+	 * 	  reload), so the active-low LED is on after CnV
+	 * 	- LED off to start with
+	 */
+	for(uint32_t channel = 0; channel < TPM_CHANNEL_COUNT; channel++){
+		if(tpm_config->channels & MASK(1U, channel)){
+			if(tpm_config->phase[channel] == tpm_phase_trailing){
+				tpm->CONTROLS[channel].CnSC =
+					TPM_CnSC_MSB_MASK |
+					TPM_CnSC_ELSB_MASK;
+				tpm->CONTROLS[channel].CnV = (uint32_t)tpm->MOD + 1;
+			}
+			else{
+				tpm->CONTROLS[channel].CnSC =
+					TPM_CnSC_MSB_MASK |
+					TPM_CnSC_ELSA_MASK;
+				tpm->CONTROLS[channel].CnV = 0;
+			}
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
 
 
+uint8_t get_tpm_prescaler(uint32_t counts, uint8_t resolution_bits){
 
 	/**
-	 * Configure TPM CnSC:
-	 * 	- Edge-aligned PWM
-	 * 	- Low-true pulses (set output on match, clear output on reload)
+	 * Used to hold the amount of bits needed to count to counts - 1
 	 */
-	TPM0->CONTROLS[channel].CnSC =
-		TPM_CnSC_MSB_MASK |
-		TPM_CnSC_ELSA_MASK;
+	uint8_t bits;
+
+	if(counts <= MASK(1UL, resolution_bits)){
+		return 0;
+	}
+	bits = (uint8_t)(32 - __builtin_clz(counts - 1));
+
+	return ((uint8_t)(bits - resolution_bits));
+}
 
 
 
+void tpm_period_update(void){
+
 	/**
-	 * Set initial duty cycle
+	 * Used to hold the current period within the dither pattern and the
+	 * duties being output
 	 */
-	TPM0->CONTROLS[channel].CnV = 0;
+	uint8_t phase;
+	volatile rgb_duty_t *rgb_duty;
 
 
 
 	/**
-	 * Configure the TPM SC register:
-	 * 	- Start TPM
+	 * Acknowledge the overflow (TOF is write 1 to clear)
 	 */
-	TPM0->SC |= TPM_SC_CMOD(SC_CMOD);
+	TPM0->SC |= TPM_SC_TOF_MASK;
+
+
+
+	/**
+	 * A fade streams its own CnV values by DMA, so leave the channels to it.
+	 * No scene plays meanwhile, since the two refuse to start over each
+	 * other
+	 */
+	if(fade_active){
+		return;
+	}
+
+
+
+	/**
+	 * Commit a published triple by swapping buffers
+	 */
+	if(rgb_duty_pending){
+		rgb_duty_active ^= 1;
+		rgb_duty_pending = false;
+	}
+	rgb_duty = &rgb_duty_buffers[rgb_duty_active];
+
+
+
+	/**
+	 * Load each channel's base count, plus one if this period is set in its
+	 * pattern
+	 */
+	phase = (dither_phase + 1) & (TPM_DITHER_PHASES - 1);
+	dither_phase = phase;
+
+	TPM2->CONTROLS[TPM2_RED_LED_CHANNEL].CnV = rgb_duty->red.base + ((rgb_duty->red.pattern >> phase) & 1);
+	TPM2->CONTROLS[TPM2_GREEN_LED_CHANNEL].CnV = rgb_duty->green.base + ((rgb_duty->green.pattern >> phase) & 1);
+	TPM0->CONTROLS[TPM0_BLUE_LED_CHANNEL].CnV = rgb_duty->blue.base + ((rgb_duty->blue.pattern >> phase) & 1);
+
+
+
+	/**
+	 * Step any playing scene, which publishes for the next period
+	 */
+	scene_period_update();
 }
 
 
 
-void init_onboard_tpm2(uint32_t channel, uint16_t mod){
+void TPM0_IRQHandler(void){
 
 	/**
-	 * Enable clock to TPM module 2
+	 * Used to hold the TPM0 counts since the overflow
 	 */
-	SIM->SCGC6 |= SIM_SCGC6_TPM2_MASK;
+	uint32_t counts = TPM0->CNT;
 
 
 
 	/**
-	 * Configure SOPT2:
-	 * 	- To use MCGFLLCLK as clock source
+	 * Counting up, CNT restarted from 0 at the overflow. Counting up-down,
+	 * the overflow is at MOD and CNT has been counting down from it since
 	 */
-	SIM->SOPT2 &=
-		~(SIM_SOPT2_TPMSRC_MASK |
-		SIM_SOPT2_PLLFLLSEL_MASK);
-	SIM->SOPT2 |=
-		SIM_SOPT2_TPMSRC(SOPT2_TPMSRC) |
-		SIM_SOPT2_PLLFLLSEL(SOPT2_PLLFLLSEL);
+	if(TPM0->SC & TPM_SC_CPWMS_MASK){
+		counts = TPM0->MOD - counts;
+	}
+	record_latency(&pwm_commit_latency, counts);
+
+	tpm_period_update();
+}
 
 
 
+void get_pwm_commit_latency(uint32_t *max_cycles, uint32_t *average_cycles){
+
 	/**
-	 * Set the smallest needed prescaler along with PWM period for
-	 * desired PWM frequency
-	 *
-	 * TPM->SC[PS] holds x for 2^x, where 2^x is the tpm_prescaler
-	 *
-	 * Configure the TPM SC register:
-	 * 	- Count up with divide by tpm_prescaler
+	 * Used to hold a consistent copy of the statistics, and the core clock
+	 * cycles per TPM0 count
 	 */
-	uint8_t tpm_sc_ps;
-	tpm_sc_ps = get_smallest_prescaler(TPM_CLOCK_HZ, TPM_PWM_HZ);
-	TPM2->SC = TPM_SC_PS(tpm_sc_ps);
+	uint32_t irq_mask;
+	latency_t latency;
+	uint32_t tpm_hz = CLOCK_GetFreq(kCLOCK_PllFllSelClk) >> ((TPM0->SC & TPM_SC_PS_MASK) >> TPM_SC_PS_SHIFT);
+
+	irq_mask = DisableGlobalIRQ();
+	latency = pwm_commit_latency;
+	EnableGlobalIRQ(irq_mask);
 
 
 
 	/**
-	 * Load the TPM MOD register
+	 * Convert from TPM0 counts to core clock cycles
 	 */
-	TPM2->MOD = mod;
+	*max_cycles = (uint32_t)(((uint64_t)latency.max * SystemCoreClock) / tpm_hz);
+	*average_cycles = (latency.count > 0) ? (uint32_t)(((latency.total / latency.count) * SystemCoreClock) / tpm_hz) : 0;
+}
 
 
 
+void rgb_levels_to_cnv(const int16_t level[3], uint16_t cnv[3]){
+
 	/**
-	 * Configure the TPM CONF register:
-	 * 	- Continue counting operation in debug mode
+	 * Used to hold the duty of each channel
 	 */
-	TPM2->CONF |= TPM_CONF_DBGMODE(CONF_DBGMODE);
+	uint32_t duty[3] = {level_to_duty(level[0]), level_to_duty(level[1]), level_to_duty(level[2])};
+
+	limit_rgb_power(duty);
+	cnv[0] = (uint16_t)(phase_duty(duty[0], RED_LED_PHASE) >> TPM_DITHER_BITS);
+	cnv[1] = (uint16_t)(phase_duty(duty[1], GREEN_LED_PHASE) >> TPM_DITHER_BITS);
+	cnv[2] = (uint16_t)(phase_duty(duty[2], BLUE_LED_PHASE) >> TPM_DITHER_BITS);
+}
 
 
 
+void publish_rgb_levels(int16_t red_level, int16_t green_level, int16_t blue_level){
+
 	/**
-	 * Configure TPM CnSC:
-	 * 	- Edge-aligned PWM
-	 * 	- Low-true pulses (set output on match, clear output on reload)
+	 * Used to hold the requested levels, the duty of each channel and the
+	 * interrupt mask while staging
 	 */
-	TPM2->CONTROLS[channel].CnSC =
-		TPM_CnSC_MSB_MASK |
-		TPM_CnSC_ELSA_MASK;
+	int16_t requested[3] = {red_level, green_level, blue_level};
+	uint32_t duty[3];
+	uint32_t irq_mask;
 
 
 
 	/**
-	 * Set initial duty cycle
+	 * Correct for this board's LEDs and hold the triple to the power budget.
+	 * current_*_level keep the requested levels
 	 */
-	TPM2->CONTROLS[channel].CnV = 0;
+	calibrate_rgb_levels(&red_level, &green_level, &blue_level);
+	duty[0] = level_to_duty(red_level);
+	duty[1] = level_to_duty(green_level);
+	duty[2] = level_to_duty(blue_level);
+	limit_rgb_power(duty);
 
 
 
 	/**
-	 * Configure the TPM SC register:
-	 * 	- Start TPM
+	 * Stage and publish the triple in one go, along with the levels it came
+	 * from. Every channel is overwritten, so the staged buffer need not
+	 * start from the duties being output
 	 */
-	TPM2->SC |= TPM_SC_CMOD(SC_CMOD);
+	irq_mask = DisableGlobalIRQ();
+	current_red_level = requested[0];
+	current_green_level = requested[1];
+	current_blue_level = requested[2];
+	stage_rgb_duty(false);
+	ANALOG_SET_RED_LED(duty[0]);
+	ANALOG_SET_GREEN_LED(duty[1]);
+	ANALOG_SET_BLUE_LED(duty[2]);
+	rgb_duty_pending = true;
+	EnableGlobalIRQ(irq_mask);
 }
 
 
 
-uint8_t get_smallest_prescaler(uint32_t tpm_clock_hz, uint32_t tpm_pwm_hz){
+void init_duty_table(void){
 
+	/**
+	 * Used to hold the amount of duty steps in a PWM period. CnV above MOD
+	 * keeps the output asserted for the whole period
+	 */
+	uint32_t steps = ((uint32_t)tpm_mod + 1);
 
 	/**
-	 * Calculate the smallest needed prescaler to allow for largest
-	 * possible TPM->MOD value and thus more granular control
+	 * Used to hold the weighted duty sum with every channel at full duty,
+	 * and the scale for each entry of the reciprocal table
 	 */
+	uint32_t full_power;
+	uint64_t scale;
 
-	uint8_t return_value;
 
-	if(((tpm_clock_hz / tpm_pwm_hz) / MAX_TPM_MOD_VALUE) < 1){
-		return_value = 0;
-	}
-	else if(((tpm_clock_hz / tpm_pwm_hz) / MAX_TPM_MOD_VALUE) < 2){
-		return_value = 1;
-	}
-	else if(((tpm_clock_hz / tpm_pwm_hz) / MAX_TPM_MOD_VALUE) < 4){
-		return_value = 2;
-	}
-	else if(((tpm_clock_hz / tpm_pwm_hz) / MAX_TPM_MOD_VALUE) < 8){
-		return_value = 3;
-	}
-	else if(((tpm_clock_hz / tpm_pwm_hz) / MAX_TPM_MOD_VALUE) < 16){
-		return_value = 4;
-	}
-	else if(((tpm_clock_hz / tpm_pwm_hz) / MAX_TPM_MOD_VALUE) < 32){
-		return_value = 5;
+
+	/**
+	 * Scale each level to the duty range once, keeping TPM_DITHER_BITS
+	 * fractional bits and rounding to nearest
+	 */
+	for(int level = 0; level < RGB_LEVELS; level++){
+#if TPM_GAMMA_CORRECTION
+		duty_table[level] = ((((uint32_t)cie_lightness_table[level] * steps) + MASK(1UL, 15 - TPM_DITHER_BITS)) >> (16 - TPM_DITHER_BITS));
+#else
+		duty_table[level] = ((((uint32_t)level * steps) << TPM_DITHER_BITS) / (RGB_LEVELS - 1));
+#endif
 	}
-	else if(((tpm_clock_hz / tpm_pwm_hz) / MAX_TPM_MOD_VALUE) < 64){
-		return_value = 6;
+
+
+
+	/**
+	 * Size the reciprocal table to cover every weighted duty sum up to all
+	 * channels at full duty. Each entry scales the top of its range back to
+	 * the budget, and leaves sums within the budget untouched
+	 */
+	full_power = (LED_RED_FULL_MA + LED_GREEN_FULL_MA + LED_BLUE_FULL_MA) * duty_table[RGB_LEVELS - 1];
+	led_power_budget = LED_POWER_BUDGET_MA * duty_table[RGB_LEVELS - 1];
+	led_power_shift = (uint8_t)(32 - __builtin_clz(full_power | 1));
+	if(led_power_shift > __builtin_ctz(LED_POWER_RECIPROCALS)){
+		led_power_shift -= __builtin_ctz(LED_POWER_RECIPROCALS);
 	}
 	else{
-		return_value = 7;
+		led_power_shift = 0;
+	}
+	for(uint32_t i = 0; i < LED_POWER_RECIPROCALS; i++){
+		scale = ((uint64_t)led_power_budget << LED_POWER_SCALE_BITS) / ((uint64_t)(i + 1) << led_power_shift);
+		if(scale > MASK(1UL, LED_POWER_SCALE_BITS)){
+			scale = MASK(1UL, LED_POWER_SCALE_BITS);
+		}
+		led_power_reciprocals[i] = (uint16_t)scale;
 	}
 
-	return (return_value);
+
+
+	/**
+	 * Build the pattern for each fraction: period n is set if its
+	 * bit-reversed index is below the fraction
+	 */
+	for(int fraction = 0; fraction < TPM_DITHER_PHASES; fraction++){
+		dither_patterns[fraction] = 0;
+		for(int period = 0; period < TPM_DITHER_PHASES; period++){
+			int reversed = 0;
+			for(int bit = 0; bit < TPM_DITHER_BITS; bit++){
+				reversed |= ((period >> bit) & 1) << (TPM_DITHER_BITS - 1 - bit);
+			}
+			if(reversed < fraction){
+				dither_patterns[fraction] |= (uint16_t)MASK(1UL, period);
+			}
+		}
+	}
 }
 
 
@@ -411,104 +976,67 @@ uint8_t get_smallest_prescaler(uint32_t tpm_clock_hz, uint32_t tpm_pwm_hz){
 void analog_control_onboard_leds(led_color_t led_color, led_action_t led_action){
 
 	/**
-	 * Control LEDs based on specified LED(s), then action
+	 * Used to hold the current levels corrected for this board's LEDs, and
+	 * their duties held to the power budget
 	 */
-	switch(led_color){
-	case red:
-		switch(led_action){
-		case analog_clear:
+	int16_t red_level = current_red_level;
+	int16_t green_level = current_green_level;
+	int16_t blue_level = current_blue_level;
+	uint32_t duty[3];
+	uint32_t irq_mask;
+
+	calibrate_rgb_levels(&red_level, &green_level, &blue_level);
+	duty[0] = level_to_duty(red_level);
+	duty[1] = level_to_duty(green_level);
+	duty[2] = level_to_duty(blue_level);
+	limit_rgb_power(duty);
+
+
+
+	/**
+	 * Stage without any other writer in between. Untouched channels keep
+	 * their level
+	 */
+	irq_mask = DisableGlobalIRQ();
+	stage_rgb_duty(true);
+
+
+
+	/**
+	 * Control each LED included in the specified color
+	 */
+	switch(led_action){
+	case analog_clear:
+		if(led_color & red){
 			ANALOG_CLEAR_RED_LED();
-			break;
-		case analog_set:
-			ANALOG_SET_RED_LED(current_red_level);
-			break;
-		default:
-			break;
 		}
-		break;
-	case green:
-		switch(led_action){
-		case analog_clear:
+		if(led_color & green){
 			ANALOG_CLEAR_GREEN_LED();
-			break;
-		case analog_set:
-			ANALOG_SET_GREEN_LED(current_green_level);
-			break;
-		default:
-			break;
 		}
-		break;
-	case blue:
-		switch(led_action){
-		case analog_clear:
+		if(led_color & blue){
 			ANALOG_CLEAR_BLUE_LED();
-			break;
-		case analog_set:
-			ANALOG_SET_BLUE_LED(current_blue_level);
-			break;
-		default:
-			break;
 		}
 		break;
-	case cyan:
-		switch(led_action){
-		case analog_clear:
-			ANALOG_CLEAR_GREEN_LED();
-			ANALOG_CLEAR_BLUE_LED();
-			break;
-		case analog_set:
-			ANALOG_SET_GREEN_LED(current_green_level);
-			ANALOG_SET_BLUE_LED(current_blue_level);
-			break;
-		default:
-			break;
+	case analog_set:
+		if(led_color & red){
+			ANALOG_SET_RED_LED(duty[0]);
 		}
-		break;
-	case magenta:
-		switch(led_action){
-		case analog_clear:
-			ANALOG_CLEAR_RED_LED();
-			ANALOG_CLEAR_BLUE_LED();
-			break;
-		case analog_set:
-			ANALOG_SET_RED_LED(current_red_level);
-			ANALOG_SET_BLUE_LED(current_blue_level);
-			break;
-		default:
-			break;
-		}
-		break;
-	case yellow:
-		switch(led_action){
-		case analog_clear:
-			ANALOG_CLEAR_RED_LED();
-			ANALOG_CLEAR_GREEN_LED();
-			break;
-		case analog_set:
-			ANALOG_SET_RED_LED(current_red_level);
-			ANALOG_SET_GREEN_LED(current_green_level);
-			break;
-		default:
-			break;
+		if(led_color & green){
+			ANALOG_SET_GREEN_LED(duty[1]);
 		}
-		break;
-	case white:
-		switch(led_action){
-		case analog_clear:
-			ANALOG_CLEAR_RED_LED();
-			ANALOG_CLEAR_GREEN_LED();
-			ANALOG_CLEAR_BLUE_LED();
-			break;
-		case analog_set:
-			ANALOG_SET_RED_LED(current_red_level);
-			ANALOG_SET_GREEN_LED(current_green_level);
-			ANALOG_SET_BLUE_LED(current_blue_level);
-			break;
-		default:
-			break;
+		if(led_color & blue){
+			ANALOG_SET_BLUE_LED(duty[2]);
 		}
 		break;
 	default:
 		break;
 	}
+
+
+
+	/**
+	 * Publish the staged triple for the next TPM0 overflow to commit
+	 */
+	rgb_duty_pending = true;
+	EnableGlobalIRQ(irq_mask);
 }
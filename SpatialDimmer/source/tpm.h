@@ -53,19 +53,173 @@
 
 
 /**
- * @brief	The value to load into TPM->MOD register. This is the amount
- * 			of levels the PWM can pulse to. Set to 255 because we are
- * 			working with RGB
+ * @brief	The desired frequency of the on-board LED PWM in Hz
  */
-#define TPM_MOD\
-	(RGB_MAX)
+#define TPM_PWM_HZ\
+	(500)
+
+
+
+/**
+ * @brief	The highest PWM resolution in bits, up to 16. The prescaler is
+ * 			chosen so TPM->MOD uses as much of this as the PWM frequency
+ * 			allows
+ * @detail
+ * 		At 48 MHz and 500 Hz this gives a prescaler of 2 and a MOD of 47999,
+ * 		so each of the 256 logical RGB levels maps to one of 48000 duty steps
+ */
+#define TPM_PWM_RESOLUTION_BITS\
+	(16)
+
+
+
+/**
+ * @brief	Set to 1 to map RGB levels to duty through the CIE 1931 lightness
+ * 			curve, so equal steps in level look like equal steps in brightness.
+ * 			Set to 0 to map RGB levels to duty linearly
+ */
+#define TPM_GAMMA_CORRECTION\
+	(1)
+
+
+
+/**
+ * @brief	The current each LED channel draws at full duty, in mA, used to
+ * 			weigh the channels against LED_POWER_BUDGET_MA. The three together
+ * 			must stay below 4096
+ */
+#define LED_RED_FULL_MA\
+	(20)
+#define LED_GREEN_FULL_MA\
+	(20)
+#define LED_BLUE_FULL_MA\
+	(20)
+
+
+
+/**
+ * @brief	The most current, in mA, all LED channels together may draw on
+ * 			average. Beyond it every channel's duty is scaled down by the same
+ * 			factor, so the color is kept and only brightness drops
+ * @detail
+ * 		The on-board LED can never exceed its supply, so the default is the
+ * 		sum of the channels. Lower it for fixtures on external drivers
+ */
+#define LED_POWER_BUDGET_MA\
+	(LED_RED_FULL_MA + LED_GREEN_FULL_MA + LED_BLUE_FULL_MA)
+
+
+
+/**
+ * @brief	The amount of entries in the power limiter's reciprocal table.
+ * 			More entries scale closer to the budget
+ */
+#define LED_POWER_RECIPROCALS\
+	(128)
+
+
+
+/**
+ * @brief	Extra bits of duty resolution gained by temporal dithering. Each
+ * 			PWM period the TPM0 overflow interrupt moves CnV between the two
+ * 			nearest counts, following a 2^TPM_DITHER_BITS period pattern
+ * @detail
+ * 		Matters most at high PWM frequencies (e.g. camera-safe 20 kHz leaves
+ * 		MOD at 2399). Set to 0 to disable dithering only: the overflow
+ * 		interrupt still commits published duties and steps scenes
+ */
+#define TPM_DITHER_BITS\
+	(4)
+
+
+
+/**
+ * @brief	The amount of PWM periods in one dither pattern
+ */
+#define TPM_DITHER_PHASES\
+	(1 << TPM_DITHER_BITS)
+
+
+
+/**
+ * @brief	The total amount of possible RGB values
+ */
+#define RGB_LEVELS\
+	((RGB_MAX - RGB_MIN) + 1)
+
+
+
+/**
+ * @brief	The amount of channels of the largest TPM instance (TPM0), and so
+ * 			the size of tpm_config_t's phase array
+ */
+#define TPM_CHANNEL_COUNT\
+	(6)
+
+
+
+/**
+ * @brief	Used to select how a TPM aligns its PWM pulses
+ * @detail
+ * 		tpm_edge_aligned:	Count up to MOD, so pulses line up with the start
+ * 							or end of the period
+ * 		tpm_center_aligned:	Count up to MOD and back down (CPWMS), so pulses
+ * 							are centered on the start or middle of the period.
+ * 							Halves the resolution for the same frequency, and
+ * 							uses at most 15 counter bits
+ */
+typedef enum tpm_alignment_e{
+	tpm_edge_aligned,
+	tpm_center_aligned
+} tpm_alignment_t;
+
+
+
+/**
+ * @brief	Used to select where in the period a channel's pulse sits
+ * @detail
+ * 		tpm_phase_leading:	Pulse starts the period (edge-aligned) or is
+ * 							centered on the period boundary (center-aligned)
+ * 		tpm_phase_trailing:	Pulse ends the period (edge-aligned) or is
+ * 							centered mid-period (center-aligned)
+ *
+ * 		Channels of one instance share a counter, so the KL25Z TPM can only
+ * 		place a pulse by its output polarity. Mixing phases on channels that
+ * 		switch together spreads their edges half a period apart
+ */
+typedef enum tpm_phase_e{
+	tpm_phase_leading,
+	tpm_phase_trailing
+} tpm_phase_t;
+
+
+
+/**
+ * @brief	Configuration of one TPM instance for PWM output
+ * @detail
+ * 		instance:			TPM0, TPM1 or TPM2
+ * 		channels:			Bit n set to use channel n
+ * 		pwm_hz:				The desired PWM frequency in Hz
+ * 		resolution_bits:	The most counter bits to use, up to 16. A lower
+ * 							resolution is used if pwm_hz requires it
+ * 		alignment:			How PWM pulses are aligned
+ * 		phase:				Where each channel's pulse sits in the period
+ */
+typedef struct tpm_config_s{
+	TPM_Type *instance;
+	uint8_t channels;
+	uint32_t pwm_hz;
+	uint8_t resolution_bits;
+	tpm_alignment_t alignment;
+	tpm_phase_t phase[TPM_CHANNEL_COUNT];
+} tpm_config_t;
 
 
 
 /**
  * @brief	Defined in tpm.c
  */
-extern int rgb_levels;
+extern uint16_t tpm_mod;
 
 
 
@@ -112,33 +266,116 @@ extern int8_t step_blue_level;
 
 
 /**
- * @brief	Initialize the on-board timer PWM module 0
- * @param	channel - The TPM0 channel to initialize
- * @param	mod - The value to load into TPM0->MOD register (this is what
- * 			TPM timer will count up to) */
-void init_onboard_tpm0(uint32_t channel, uint16_t mod);
+ * @brief	Initialize TPM0 and TPM2 to drive the on-board RGB LED
+ * @detail
+ * 		Both run at TPM_PWM_HZ with up to TPM_PWM_RESOLUTION_BITS of
+ * 		resolution. TPM2 starts on the first TPM0 overflow so both share the
+ * 		same period boundary. Green trails red and blue, so the three LEDs do
+ * 		not all switch on at the same count
+ */
+void init_onboard_tpm(void);
+
+
+
+/**
+ * @brief	Initialize a TPM instance for PWM output
+ * @param	tpm_config - The instance, channels, frequency, resolution and
+ * 			alignment to use
+ * @return	EXIT_SUCCESS if configured, EXIT_FAILURE if the instance is unknown,
+ * 			pwm_hz cannot be reached with the largest prescaler or a
+ * 			center-aligned MOD would not fit in 15 bits
+ * @detail
+ * 		The counter is left stopped with every selected channel at 0% duty,
+ * 		so instances can be started together. Start it by setting TPM->SC[CMOD]
+ */
+int init_tpm(const tpm_config_t *tpm_config);
+
+
+
+/**
+ * @brief	Calculate the smallest TPM prescaler that fits a period within a
+ * 			counter resolution
+ * @param	counts - The period in TPM clock cycles
+ * @param	resolution_bits - The counter resolution in bits, up to 16
+ * @return	x for 2^x, where 2^x is the TPM prescaler. May be above 7, the
+ * 			largest prescaler, if counts cannot fit
+ * @detail
+ * 		x is the bit length of counts - 1 beyond resolution_bits, so it is
+ * 		found with a single leading-zero count instead of a division per
+ * 		candidate prescaler
+ */
+uint8_t get_tpm_prescaler(uint32_t counts, uint8_t resolution_bits);
+
+
+
+/**
+ * @brief	Commit any published RGB levels and load the next CnV of every
+ * 			LED channel, advancing the dither pattern by one PWM period
+ * @detail
+ * 		Called from TPM0_IRQHandler() on every TPM0 overflow. The new CnV
+ * 		values take effect from the next period, since CnV is buffered in
+ * 		PWM mode
+ */
+void tpm_period_update(void);
 
 
 
 /**
- * @brief	Initialize the on-board timer PWM module 2
- * @param	channel - The TPM2 channel to initialize
- * @param	mod - The value to load into TPM2->MOD register (this is what
- * 			TPM timer will count up to)
+ * @brief	Read how long after each TPM0 overflow its interrupt started
+ * @param	max_cycles - Where to store the longest, in core clock cycles
+ * @param	average_cycles - Where to store the average, in core clock cycles
+ * @detail
+ * 		Measured from TPM0->CNT on entry, so it is exact to a TPM0 count and
+ * 		covers everything that held the commit up: masked interrupts and
+ * 		interrupts of the same priority
  */
-void init_onboard_tpm2(uint32_t channel, uint16_t mod);
+void get_pwm_commit_latency(uint32_t *max_cycles, uint32_t *average_cycles);
 
 
 
 /**
- * @brief	Calculate the smallest necessary TPM prescaler to provide the
- * 			highest granularity
- * @param	tpm_clock_hz - The frequency of the clock TPM will take
- * 			its reference from
- * @param	tpm_pwm_hz - The desired frequency of TPM output
- * @return	x for 2^x, where 2^x is the TPM prescaler
+ * @brief	Look up the whole CnV counts for an RGB triple, without dithering
+ * @param	level - The red, green and blue levels, each clamped to between
+ * 			RGB_MIN and RGB_MAX
+ * @param	cnv - Where to store the values to load into the red, green and
+ * 			blue TPM->CONTROLS[n].CnV
+ * @detail
+ * 		The triple is held to LED_POWER_BUDGET_MA like a published one, and
+ * 		each channel's phase decides how its level maps to CnV
  */
-uint8_t get_smallest_prescaler(uint32_t tpm_clock_hz, uint32_t tpm_pwm_hz);
+void rgb_levels_to_cnv(const int16_t level[3], uint16_t cnv[3]);
+
+
+
+/**
+ * @brief	Publish new RGB levels for all three LED channels
+ * @param	red_level - The new red level
+ * @param	green_level - The new green level
+ * @param	blue_level - The new blue level
+ * @detail
+ * 		Never waits on the PWM: the levels are staged and the next TPM0
+ * 		overflow commits all three at once. Publishing again before then
+ * 		replaces the staged levels. Staging masks interrupts briefly, so it
+ * 		is safe from any context and writers never mix their triples.
+ *
+ * 		This is the analog counterpart of digital_control_onboard_leds() for
+ * 		a whole RGB triple, and takes no branches on color or action. The
+ * 		levels are corrected for this board and held to LED_POWER_BUDGET_MA
+ * 		on the way to duty
+ */
+void publish_rgb_levels(int16_t red_level, int16_t green_level, int16_t blue_level);
+
+
+
+/**
+ * @brief	Build the table mapping RGB levels to TPM duty for the current
+ * 			TPM->MOD, and the power limiter's reciprocal table
+ * @detail
+ * 		Called by the TPM initialization functions, so RGB levels always map
+ * 		onto the full duty range without a multiply per update, and the
+ * 		limiter scales without a divide per update
+ */
+void init_duty_table(void);
 
 
 
@@ -147,6 +384,9 @@ uint8_t get_smallest_prescaler(uint32_t tpm_clock_hz, uint32_t tpm_pwm_hz);
  * @param	led_color - The LED color(s) to perform the action on
  * @param	led_action - The action to perform on LED color(s)
  * @detail
+ * 		The new duties are staged and take effect together at the next TPM0
+ * 		overflow, like publish_rgb_levels()
+ *
  * 		Many operations were referenced from Alexander G Dean (Chapter 2
  * 		of Embedded Systems Fundamentals with ARM Cortex-M Based Microcontrollers)
  *
@@ -164,11 +404,4 @@ void analog_control_onboard_leds(led_color_t led_color, led_action_t led_action)
 
 
 
-/**
- * @brief	Calculate current red LED level with respective to current x
- * @detail
- *
- */
-void init_onboard_tpm2(uint32_t channel, uint16_t mod);
-
 #endif /* TPM_H_ */
@@ -0,0 +1,106 @@
+/**
+ * @file	watchdog.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for the COP watchdog
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "board.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "watchdog.h"
+
+
+
+/**
+ * @brief	The watchdog record. Kept in .noinit, which the startup code
+ * 			neither loads nor zeroes, so it survives the reset
+ */
+static watchdog_record_t watchdog_record __attribute__((section(".noinit")));
+
+
+
+void init_watchdog(void){
+
+	/**
+	 * Configure all fields of COPC in its single write:
+	 * 	- Clocked from the 1 kHz LPO, which keeps running if the core clock
+	 * 	  fails
+	 * 	- Normal (not windowed) mode, so it can be fed at any time
+	 * 	- Timeout of WATCHDOG_TIMEOUT_MS
+	 */
+#ifdef BENCHMARK
+	SIM->COPC = 0;
+#else
+	SIM->COPC = SIM_COPC_COPT(WATCHDOG_COPT);
+#endif
+}
+
+
+
+void kick_watchdog(void){
+
+	SIM->SRVCOP = 0x55;
+	SIM->SRVCOP = 0xAA;
+}
+
+
+
+bool was_watchdog_reset(void){
+
+	return ((RCM->SRS0 & RCM_SRS0_WDOG_MASK) != 0);
+}
+
+
+
+void record_watchdog_late_task(const char *late_task, const char *running_task, uint16_t deadline_ticks, uint32_t late_ticks, uint32_t uptime_ticks){
+
+	/**
+	 * Copy the names, since a rebuilt image may move the strings they point
+	 * to, and keep them terminated
+	 */
+	strncpy(watchdog_record.late_task, late_task, WATCHDOG_NAME_SIZE - 1);
+	watchdog_record.late_task[WATCHDOG_NAME_SIZE - 1] = '\0';
+	strncpy(watchdog_record.running_task, (running_task != NULL) ? running_task : "", WATCHDOG_NAME_SIZE - 1);
+	watchdog_record.running_task[WATCHDOG_NAME_SIZE - 1] = '\0';
+	watchdog_record.deadline_ticks = deadline_ticks;
+	watchdog_record.late_ticks = late_ticks;
+	watchdog_record.uptime_ticks = uptime_ticks;
+	watchdog_record.cause = watchdog_late_task;
+	watchdog_record.magic = WATCHDOG_RECORD_MAGIC;
+}
+
+
+
+void record_watchdog_pll_unlocked(void){
+
+	memset(&watchdog_record, 0, sizeof(watchdog_record));
+	watchdog_record.cause = watchdog_pll_unlocked;
+	watchdog_record.magic = WATCHDOG_RECORD_MAGIC;
+}
+
+
+
+bool take_watchdog_record(watchdog_record_t *record){
+
+	/**
+	 * Used to hold whether the record is the COP or software reset's
+	 */
+	bool valid = ((was_watchdog_reset() || (RCM->SRS1 & RCM_SRS1_SW_MASK)) && (watchdog_record.magic == WATCHDOG_RECORD_MAGIC));
+
+	*record = watchdog_record;
+	watchdog_record.magic = 0;
+
+	return valid;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file	watchdog.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros and function headers for the COP watchdog
+ */
+
+
+
+#ifndef WATCHDOG_H_
+#define WATCHDOG_H_
+
+
+
+/**
+ * @brief	COPC[COPT] - COP timeout in cycles of the 1 kHz LPO
+ * @detail
+ * 		00: COP disabled
+ * 		01: 2^5 cycles (32 ms)
+ * 		10: 2^8 cycles (256 ms)
+ * 		11: 2^10 cycles (1024 ms)
+ */
+#define WATCHDOG_COPT\
+	(2)
+
+
+
+/**
+ * @brief	The COP timeout in ms set by WATCHDOG_COPT
+ */
+#define WATCHDOG_TIMEOUT_MS\
+	(256)
+
+
+
+/**
+ * @brief	Identifies a watchdog record kept through a reset ("LATE")
+ */
+#define WATCHDOG_RECORD_MAGIC\
+	(0x4C415445UL)
+
+
+
+/**
+ * @brief	The longest task name kept in a late task record, including its
+ * 			terminator
+ */
+#define WATCHDOG_NAME_SIZE\
+	(12)
+
+
+
+/**
+ * @brief	Why the MCU was reset on purpose
+ * @detail
+ * 		watchdog_late_task:		A task missed its deadline and the COP was
+ * 								left to time out
+ * 		watchdog_pll_unlocked:	The PLL did not lock again after VLPS, so
+ * 								idle reset the MCU (see idle.h)
+ */
+typedef enum watchdog_cause_e{
+	watchdog_late_task,
+	watchdog_pll_unlocked
+} watchdog_cause_t;
+
+
+
+/**
+ * @brief	Why the MCU was reset on purpose, kept through the reset
+ * @detail
+ * 		magic:			WATCHDOG_RECORD_MAGIC while the record is valid
+ * 		cause:			Why the MCU was reset. The fields below are only
+ * 						filled in for watchdog_late_task
+ * 		late_task:		The task that missed its deadline
+ * 		running_task:	The task running when the deadline passed, or empty
+ * 						if the main loop was between tasks
+ * 		deadline_ticks:	The deadline the late task missed
+ * 		late_ticks:		Ticks since the late task last finished a run
+ * 		uptime_ticks:	Ticks since the scheduler started
+ */
+typedef struct watchdog_record_s{
+	uint32_t magic;
+	watchdog_cause_t cause;
+	char late_task[WATCHDOG_NAME_SIZE];
+	char running_task[WATCHDOG_NAME_SIZE];
+	uint16_t deadline_ticks;
+	uint32_t late_ticks;
+	uint32_t uptime_ticks;
+} watchdog_record_t;
+
+
+
+/**
+ * @brief	Configure the COP watchdog
+ * @detail
+ * 		Built with DISABLE_WDOG=0, so SystemInit() leaves the COP running
+ * 		from reset with its 1024 ms default. COPC can only be written once
+ * 		after reset, so this sets the timeout for good: call it early in
+ * 		main(), then feed with kick_watchdog().
+ *
+ * 		BENCHMARK builds turn the COP off here instead, since the benchmarks
+ * 		run for seconds without returning to the scheduler
+ */
+void init_watchdog(void);
+
+
+
+/**
+ * @brief	Restart the COP timeout
+ * @detail
+ * 		Writes 0x55 then 0xAA to SRVCOP. Only feed it from one context, so
+ * 		the two writes are never split by another feed
+ */
+void kick_watchdog(void);
+
+
+
+/**
+ * @brief	Check whether the last reset was the COP timing out
+ * @return	true if the COP reset the MCU, otherwise false
+ */
+bool was_watchdog_reset(void);
+
+
+
+/**
+ * @brief	Note why the watchdog is about to reset the MCU
+ * @param	late_task - The name of the task that missed its deadline
+ * @param	running_task - The name of the task running, or NULL
+ * @param	deadline_ticks - The deadline the late task missed
+ * @param	late_ticks - Ticks since the late task last finished a run
+ * @param	uptime_ticks - Ticks since the scheduler started
+ * @detail
+ * 		Only copies into a record in RAM the startup code does not clear, so
+ * 		it is safe from any interrupt and never waits on the debug UART. The
+ * 		record is read back after the reset with take_watchdog_record()
+ */
+void record_watchdog_late_task(const char *late_task, const char *running_task, uint16_t deadline_ticks, uint32_t late_ticks, uint32_t uptime_ticks);
+
+
+
+/**
+ * @brief	Note that the PLL did not lock again, just before a software reset
+ * @detail
+ * 		Like record_watchdog_late_task(), only copies into the record kept
+ * 		through the reset
+ */
+void record_watchdog_pll_unlocked(void);
+
+
+
+/**
+ * @brief	Take the record left by the last reset, if any
+ * @param	record - Where to copy the record out to
+ * @return	true if the last reset was the COP or a software reset and a
+ * 			record was left, otherwise false
+ * @detail
+ * 		The record is invalidated either way, so it is only reported once
+ * 		and never after a reset of another kind
+ */
+bool take_watchdog_record(watchdog_record_t *record);
+
+
+
+#endif /* WATCHDOG_H_ */
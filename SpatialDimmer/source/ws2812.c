@@ -0,0 +1,302 @@
+/**
+ * @file	ws2812.c
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Function definitions for WS2812 addressable LED strips
+ */
+
+
+
+/**
+ * Include pre-defined libraries
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include "board.h"
+#include "fsl_clock.h"
+
+
+
+/**
+ * User-defined libraries
+ */
+#include "led.h"
+#include "tpm.h"
+#include "ws2812.h"
+
+
+
+/**
+ * @brief	PCR is a 32-bit register where bits 8:10 are a MUX field
+ * 			(see Chapter 10 of KL25 Sub-Family Reference Manual)
+ * @detail
+ * 		010 = Alternative 2 (SPI0_MOSI on PTD2)
+ */
+#define PCR_MUX_SPI_WS2812\
+	(2)
+
+
+
+/**
+ * @brief	The pin of PORTD driving the strip's data line
+ */
+#define PORTD_WS2812_PIN\
+	(2)
+
+
+
+/**
+ * @brief	The DMA channel feeding SPI0. Channels 0 to 2 are used by fades
+ */
+#define WS2812_DMA_CHANNEL\
+	(3)
+
+
+
+/**
+ * @brief	The DMAMUX request source for SPI0 transmit
+ */
+#define WS2812_DMAMUX_SOURCE\
+	(17)
+
+
+
+/**
+ * @brief	The largest SPI baud rate prescaler (SPPR + 1)
+ */
+#define WS2812_MAX_SPPR_DIVISOR\
+	(8)
+
+
+
+/**
+ * @brief	The size of the frame buffer, including the latch bytes
+ */
+#define WS2812_FRAME_BYTES\
+	((WS2812_PIXELS * WS2812_BYTES_PER_PIXEL) + WS2812_LATCH_BYTES)
+
+
+
+/**
+ * @brief	Set while DMA is sending a frame
+ */
+volatile bool ws2812_busy = false;
+
+
+
+/**
+ * @brief	The SPI bit pattern of every nibble: each bit b becomes 1b0
+ */
+static const uint16_t ws2812_nibble_patterns[16] = {
+	0x924, 0x926, 0x934, 0x936, 0x9A4, 0x9A6, 0x9B4, 0x9B6,
+	0xD24, 0xD26, 0xD34, 0xD36, 0xDA4, 0xDA6, 0xDB4, 0xDB6
+};
+
+
+
+/**
+ * @brief	The frame buffer, already encoded as SPI bit patterns in the
+ * 			strip's GRB order. The trailing latch bytes stay 0
+ */
+static uint8_t ws2812_frame[WS2812_FRAME_BYTES];
+
+
+
+/**
+ * @brief	The SPI bit rate actually reached, and whether SPI0 is set up
+ */
+static uint32_t ws2812_spi_hz = WS2812_SPI_HZ;
+static bool ws2812_ready = false;
+
+
+
+/**
+ * @brief	Encode one color byte into 3 bytes of SPI bit pattern
+ * @param	encoded - Where to store the pattern
+ * @param	level - The RGB level, clamped to between RGB_MIN and RGB_MAX
+ */
+static inline void ws2812_encode(uint8_t *encoded, int16_t level){
+
+	/**
+	 * Used to hold the 24-bit pattern
+	 */
+	uint32_t pattern;
+
+	if(level < RGB_MIN){
+		level = RGB_MIN;
+	}
+	else if(level > RGB_MAX){
+		level = RGB_MAX;
+	}
+
+	pattern = ((uint32_t)ws2812_nibble_patterns[(uint8_t)level >> 4] << 12) | ws2812_nibble_patterns[level & 0xF];
+	encoded[0] = (uint8_t)(pattern >> 16);
+	encoded[1] = (uint8_t)(pattern >> 8);
+	encoded[2] = (uint8_t)pattern;
+}
+
+
+
+int init_ws2812(void){
+
+	/**
+	 * Used to hold the SPI baud rate divisor after the fixed divide by 2
+	 */
+	uint32_t divisor;
+
+
+
+	/**
+	 * Find the divisor of the bus clock closest to WS2812_SPI_HZ
+	 */
+	divisor = (CLOCK_GetBusClkFreq() + WS2812_SPI_HZ) / (2 * WS2812_SPI_HZ);
+	if((divisor == 0) || (divisor > WS2812_MAX_SPPR_DIVISOR)){
+		return EXIT_FAILURE;
+	}
+	ws2812_spi_hz = CLOCK_GetBusClkFreq() / (2 * divisor);
+
+
+
+	/**
+	 * Route SPI0 MOSI to the data pin
+	 */
+	SIM->SCGC5 |= SIM_SCGC5_PORTD_MASK;
+	PORTD->PCR[PORTD_WS2812_PIN] &= ~PORT_PCR_MUX_MASK;
+	PORTD->PCR[PORTD_WS2812_PIN] |= PORT_PCR_MUX(PCR_MUX_SPI_WS2812);
+
+
+
+	/**
+	 * Configure SPI0:
+	 * 	- Master, MSB first, SS pin left as GPIO
+	 * 	- Bus clock / (2 * divisor)
+	 * 	- Transmit DMA requests enabled only while a frame is sent
+	 */
+	SIM->SCGC4 |= SIM_SCGC4_SPI0_MASK;
+	SPI0->C1 = SPI_C1_MSTR_MASK;
+	SPI0->C2 = 0;
+	SPI0->BR = SPI_BR_SPPR(divisor - 1) | SPI_BR_SPR(0);
+	SPI0->C1 |= SPI_C1_SPE_MASK;
+
+
+
+	/**
+	 * Configure DMA channel 3 to interrupt when a frame is sent
+	 */
+	SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+	SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+	DMAMUX0->CHCFG[WS2812_DMA_CHANNEL] = 0;
+	DMA0->DMA[WS2812_DMA_CHANNEL].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+	NVIC_EnableIRQ(DMA3_IRQn);
+
+	ws2812_ready = true;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+void set_ws2812_pixel(uint16_t pixel, int16_t red_level, int16_t green_level, int16_t blue_level){
+
+	/**
+	 * Used to hold where the pixel starts in the frame buffer
+	 */
+	uint8_t *encoded;
+
+	if(pixel >= WS2812_PIXELS){
+		return;
+	}
+	encoded = &ws2812_frame[pixel * WS2812_BYTES_PER_PIXEL];
+
+	ws2812_encode(&encoded[0], green_level);
+	ws2812_encode(&encoded[3], red_level);
+	ws2812_encode(&encoded[6], blue_level);
+}
+
+
+
+void fill_ws2812_pixels(int16_t red_level, int16_t green_level, int16_t blue_level){
+
+	/**
+	 * Used to hold the encoded pixel
+	 */
+	uint8_t encoded[WS2812_BYTES_PER_PIXEL];
+
+
+
+	/**
+	 * Encode once and copy to every pixel
+	 */
+	ws2812_encode(&encoded[0], green_level);
+	ws2812_encode(&encoded[3], red_level);
+	ws2812_encode(&encoded[6], blue_level);
+	for(uint32_t i = 0; i < (WS2812_PIXELS * WS2812_BYTES_PER_PIXEL); i += WS2812_BYTES_PER_PIXEL){
+		for(uint32_t j = 0; j < WS2812_BYTES_PER_PIXEL; j++){
+			ws2812_frame[i + j] = encoded[j];
+		}
+	}
+}
+
+
+
+int show_ws2812_pixels(void){
+
+	if(!ws2812_ready || ws2812_busy){
+		return EXIT_FAILURE;
+	}
+	ws2812_busy = true;
+
+
+
+	/**
+	 * Configure DMA channel 3:
+	 * 	- 8-bit reads from the incrementing frame buffer into SPI0->D
+	 * 	- One byte per SPI0 transmit request (cycle steal)
+	 * 	- Stop requesting and interrupt once the whole frame is written
+	 */
+	DMA0->DMA[WS2812_DMA_CHANNEL].SAR = (uint32_t)(uintptr_t)ws2812_frame;
+	DMA0->DMA[WS2812_DMA_CHANNEL].DAR = (uint32_t)(uintptr_t)&SPI0->D;
+	DMA0->DMA[WS2812_DMA_CHANNEL].DSR_BCR = DMA_DSR_BCR_BCR(WS2812_FRAME_BYTES);
+	DMA0->DMA[WS2812_DMA_CHANNEL].DCR =
+		DMA_DCR_EINT_MASK |
+		DMA_DCR_ERQ_MASK |
+		DMA_DCR_CS_MASK |
+		DMA_DCR_SINC_MASK |
+		DMA_DCR_SSIZE(1) |
+		DMA_DCR_DSIZE(1) |
+		DMA_DCR_D_REQ_MASK;
+
+
+
+	/**
+	 * Route SPI0 transmit to channel 3. The transmit buffer is empty, so the
+	 * first request is made as soon as DMA requests are enabled
+	 */
+	DMAMUX0->CHCFG[WS2812_DMA_CHANNEL] =
+		DMAMUX_CHCFG_ENBL_MASK |
+		DMAMUX_CHCFG_SOURCE(WS2812_DMAMUX_SOURCE);
+	SPI0->C2 |= SPI_C2_TXDMAE_MASK;
+
+	return EXIT_SUCCESS;
+}
+
+
+
+uint32_t get_ws2812_refresh_centihz(uint16_t pixels){
+
+	return ((ws2812_spi_hz * 100) / ((((uint32_t)pixels * WS2812_BYTES_PER_PIXEL) + WS2812_LATCH_BYTES) * 8));
+}
+
+
+
+void DMA3_IRQHandler(void){
+
+	/**
+	 * The latch bytes are still shifting out, but they are all 0 so the next
+	 * frame can be queued behind them
+	 */
+	DMA0->DMA[WS2812_DMA_CHANNEL].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+	SPI0->C2 &= ~SPI_C2_TXDMAE_MASK;
+	DMAMUX0->CHCFG[WS2812_DMA_CHANNEL] = 0;
+	ws2812_busy = false;
+}
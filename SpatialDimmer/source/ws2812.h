@@ -0,0 +1,121 @@
+/**
+ * @file	ws2812.h
+ * @author	Dayton Flores (dafl2542@colorado.edu)
+ * @date	10/18/2026
+ * @brief	Macros and function headers for WS2812 addressable LED strips
+ */
+
+
+
+#ifndef WS2812_H_
+#define WS2812_H_
+
+
+
+/**
+ * @brief	The amount of pixels on the strip
+ * @detail
+ * 		Each pixel takes WS2812_BYTES_PER_PIXEL bytes of SRAM, so 300 pixels
+ * 		fit in under 3 KB
+ */
+#define WS2812_PIXELS\
+	(300)
+
+
+
+/**
+ * @brief	The SPI bit rate. Three SPI bits make one 1.25 us WS2812 bit:
+ * 			100 is a 0 and 110 is a 1
+ */
+#define WS2812_SPI_HZ\
+	(2400000)
+
+
+
+/**
+ * @brief	Bytes of SPI bit pattern per pixel: 24 color bits of 3 SPI bits
+ */
+#define WS2812_BYTES_PER_PIXEL\
+	(9)
+
+
+
+/**
+ * @brief	Low bytes sent after the pixels to latch the frame. 90 bytes at
+ * 			2.4 MHz hold the line low for 300 us, enough for WS2812B
+ */
+#define WS2812_LATCH_BYTES\
+	(90)
+
+
+
+/**
+ * @brief	Defined in ws2812.c
+ */
+extern volatile bool ws2812_busy;
+
+
+
+/**
+ * @brief	Initialize SPI0 and DMA channel 3 to drive a WS2812 strip
+ * @return	EXIT_SUCCESS, or EXIT_FAILURE if the bus clock cannot be divided
+ * 			down to WS2812_SPI_HZ
+ * @detail
+ * 		The strip's data line connects to PTD2 (SPI0 MOSI). SCK is not routed
+ * 		to a pin since PTD1 drives the blue on-board LED
+ */
+int init_ws2812(void);
+
+
+
+/**
+ * @brief	Set the color of one pixel in the frame buffer
+ * @param	pixel - The pixel, from 0 nearest the board
+ * @param	red_level - The red level between RGB_MIN and RGB_MAX
+ * @param	green_level - The green level between RGB_MIN and RGB_MAX
+ * @param	blue_level - The blue level between RGB_MIN and RGB_MAX
+ * @detail
+ * 		The frame buffer holds SPI bit patterns, so each byte of color is
+ * 		encoded here with two lookups of a 16-entry nibble table and DMA
+ * 		streams the buffer as is. Pixels past WS2812_PIXELS are ignored
+ */
+void set_ws2812_pixel(uint16_t pixel, int16_t red_level, int16_t green_level, int16_t blue_level);
+
+
+
+/**
+ * @brief	Set every pixel in the frame buffer to one color
+ * @param	red_level - The red level between RGB_MIN and RGB_MAX
+ * @param	green_level - The green level between RGB_MIN and RGB_MAX
+ * @param	blue_level - The blue level between RGB_MIN and RGB_MAX
+ */
+void fill_ws2812_pixels(int16_t red_level, int16_t green_level, int16_t blue_level);
+
+
+
+/**
+ * @brief	Send the frame buffer to the strip
+ * @return	EXIT_SUCCESS if started, EXIT_FAILURE if the previous frame is
+ * 			still being sent
+ * @detail
+ * 		Returns at once: DMA feeds SPI0 one byte per request and
+ * 		DMA3_IRQHandler() clears ws2812_busy once the latch bytes are queued.
+ * 		Pixels should not be set while ws2812_busy, or the frame may tear
+ */
+int show_ws2812_pixels(void);
+
+
+
+/**
+ * @brief	Calculate the highest refresh rate of a strip
+ * @param	pixels - The amount of pixels on the strip
+ * @return	Frames per second, in hundredths
+ * @detail
+ * 		Each pixel takes 30 us on the wire and each frame WS2812_LATCH_BYTES
+ * 		more, so 300 pixels refresh at about 107 Hz
+ */
+uint32_t get_ws2812_refresh_centihz(uint16_t pixels);
+
+
+
+#endif /* WS2812_H_ */